@@ -1,6 +1,11 @@
 #include "Application.hpp"
 #include "../adapters/storage/FileSystemRepository.hpp"
 #include "../adapters/http/BeastHttpServer.hpp"
+#include "../adapters/storage/MediaReader.hpp"
+#include "../adapters/http/CatalogCache.hpp"
+#include "../adapters/storage/IoPriority.hpp"
+#include "../adapters/storage/LibraryWatcher.hpp"
+#include "../adapters/storage/FaststartOptimizer.hpp"
 #include "Logger.hpp"
 
 namespace venturi {
@@ -10,17 +15,79 @@ Application::Application(const Config& config)
 {
   LOG_INFO("Initializing application...");
   
-  media_repository_ = std::make_shared<adapters::FileSystemRepository>(
+  adapters::ParallelScanner::Options scan_options;
+  scan_options.threads = config_.scan_threads;
+  scan_options.batch_size = config_.scan_batch_size;
+
+  auto repository = std::make_shared<adapters::FileSystemRepository>(
     config_.media_root,
-    config_.transcode_output
+    config_.transcode_output,
+    scan_options,
+    config_.catalog_index,
+    config_.probe_containers
   );
+  media_repository_ = repository;
+
+  size_t restored = repository->load_index();
+  catalog_restored_ = restored > 0;
+  if (catalog_restored_) {
+    LOG_INFO("Restored ", restored, " media files from ", config_.catalog_index.string());
+  }
   
-  media_service_ = std::make_shared<core::MediaService>(
-    media_repository_
+  core::JobManager::Options job_options;
+  job_options.worker_count = config_.job_workers;
+  // A faststart pass is paced and can run for hours; scans must not wait.
+  job_options.dedicated_kinds = { "faststart" };
+  job_options.history = config_.job_history;
+  job_options.on_worker_start = adapters::make_current_thread_background;
+
+  media_service_ = std::make_shared<adapters::MediaService>(
+    media_repository_,
+    std::move(job_options)
   );
 
+  media_reader_ = std::make_shared<adapters::MediaReader>(config_);
+  catalog_cache_ = std::make_shared<adapters::CatalogCache>(media_service_, config_);
+
+  if (config_.faststart_enabled && config_.probe_containers) {
+    faststart_optimizer_ = std::make_shared<adapters::FaststartOptimizer>(
+      repository,
+      adapters::FaststartOptimizer::Options{
+        std::filesystem::absolute(config_.transcode_output),
+        config_.faststart_max_bytes_per_second
+      }
+    );
+  }
+
+  if (config_.watch_library) {
+    // Lost events are recovered by a background rescan, deduplicated
+    // against one already running.
+    adapters::LibraryWatcher::Options watch_options;
+    watch_options.debounce = std::chrono::milliseconds{ config_.watch_debounce_ms };
+    watch_options.on_overflow = [this] {
+      media_service_->start_scan(config_.media_root);
+      queue_faststart();
+    };
+    watch_options.on_change = [this] {
+      queue_faststart();
+    };
+    // Keyed by path, so a directory reported twice is scanned once.
+    watch_options.on_new_directory = [this](const std::filesystem::path& directory) {
+      media_service_->start_scan(directory);
+      queue_faststart();
+    };
+
+    library_watcher_ = std::make_shared<adapters::LibraryWatcher>(
+      repository,
+      std::filesystem::absolute(config_.media_root),
+      std::move(watch_options)
+    );
+  }
+
   http_server_ = std::make_shared<adapters::BeastHttpServer>(
     media_service_,
+    media_reader_,
+    catalog_cache_,
     config_
   );
   
@@ -29,18 +96,63 @@ Application::Application(const Config& config)
 
 void Application::start_services() {
   LOG_INFO("Starting services...");
+
+  // A restored catalog can be served at once; the watcher and a background
+  // scan then catch up with whatever changed while we were down.
+  if (catalog_restored_) {
+    http_server_->start(config_.host, config_.port, config_.thread_count);
+  }
   
-  LOG_INFO("Performing initial media scan...");
-  size_t count = media_service_->scan_media_directory(config_.media_root);
-  LOG_INFO("Found ", count, " media files");
+  // Watch before scanning so nothing changed during the scan is missed.
+  if (library_watcher_) {
+    library_watcher_->start();
+  }
+
+  if (catalog_restored_) {
+    LOG_INFO("Reconciling the restored catalog in the background...");
+    media_service_->start_scan(config_.media_root);
+  } else {
+    LOG_INFO("Performing initial media scan...");
+    size_t count = media_service_->scan_media_directory(config_.media_root);
+    LOG_INFO("Found ", count, " media files");
+  }
+
+  queue_faststart();
+
+  if (config_.header_cache_warm_on_scan) {
+    media_reader_->warm_headers(media_service_->list_all_media());
+  }
   
-  http_server_->start(config_.host, config_.port, config_.thread_count);
+  if (!catalog_restored_) {
+    http_server_->start(config_.host, config_.port, config_.thread_count);
+  }
+}
+
+void Application::queue_faststart() {
+  if (!faststart_optimizer_) {
+    return;
+  }
+
+  // On its own lane, so it waits for pending scans to settle the catalog
+  // instead of sitting in front of them. A running pass may already have
+  // walked past whatever prompted this call, so only a queued one absorbs it.
+  media_service_->start_job("faststart", "faststart",
+    [service = media_service_.get(), optimizer = faststart_optimizer_](core::Job& job) {
+      service->wait_for_jobs("scan", job.stop_token());
+      optimizer->run(job);
+    },
+    false
+  );
 }
 
 void Application::stop_services() {
   LOG_INFO("Stopping services...");
   
   http_server_->stop();
+
+  if (library_watcher_) {
+    library_watcher_->stop();
+  }
   
   LOG_INFO("All services stopped");
 }
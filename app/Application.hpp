@@ -1,21 +1,27 @@
 #pragma once
-#include "../core/services/MediaService.hpp"
-#include "../core/ports/IMediaRepository.hpp"
-#include "../core/ports/IHttpServer.hpp"
+#include "../adapters/storage/FileSystemMediaService.hpp"
 #include "Config.hpp"
 #include <memory>
 
+namespace venturi::adapters {
+class BeastHttpServer;
+class MediaReader;
+class CatalogCache;
+class LibraryWatcher;
+class FaststartOptimizer;
+} // namespace venturi::adapters
+
 namespace venturi {
 
 class Application {
 public:
   explicit Application(const Config& config);
   
-  std::shared_ptr<core::MediaService> get_media_service() const {
+  std::shared_ptr<adapters::MediaService> get_media_service() const {
     return media_service_;
   }
   
-  std::shared_ptr<core::IHttpServer> get_http_server() const {
+  std::shared_ptr<adapters::BeastHttpServer> get_http_server() const {
     return http_server_;
   }
   
@@ -23,11 +29,19 @@ public:
   void stop_services();
 
 private:
-  // (TODO): Explore C++20 Concepts to replace with Static Polymorphism
-  std::shared_ptr<core::IMediaRepository> media_repository_;
-  std::shared_ptr<core::IHttpServer> http_server_;
-  std::shared_ptr<core::MediaService> media_service_;
+  // Queues a faststart pass over the catalog, unless one is queued already.
+  void queue_faststart();
+
+  // Held by concrete type; see core::MediaRepository and core::HttpServer.
+  std::shared_ptr<adapters::FileSystemRepository> media_repository_;
+  std::shared_ptr<adapters::BeastHttpServer> http_server_;
+  std::shared_ptr<adapters::MediaService> media_service_;
+  std::shared_ptr<adapters::MediaReader> media_reader_;
+  std::shared_ptr<adapters::CatalogCache> catalog_cache_;
+  std::shared_ptr<adapters::LibraryWatcher> library_watcher_;
+  std::shared_ptr<adapters::FaststartOptimizer> faststart_optimizer_;
   const Config& config_;
+  bool catalog_restored_ = false;
 };
 
 } // namespace venturi
\ No newline at end of file
@@ -11,10 +11,109 @@ struct Config {
   uint16_t port = 8080;
   uint32_t thread_count = std::thread::hardware_concurrency();
 
+  // One io_context per thread with its own SO_REUSEPORT acceptor, instead of
+  // every thread sharing one scheduler. Sessions stay on their shard.
+  bool sharded_io = false;
+  bool pin_io_threads = true;
+  uint32_t accepts_per_shard = 4;
+
+  // Disk-to-socket via io_uring instead of sendfile on the epoll threads.
+  // Needs a VENTURI_ENABLE_IO_URING build; ignored (with a warning) otherwise.
+  bool use_io_uring = false;
+  uint32_t io_uring_queue_depth = 256;
+
+  // A response body whose client takes nothing for this long is abandoned
+  // and its connection shut down. 0 waits forever.
+  uint32_t send_idle_timeout_seconds = 60;
+
   std::filesystem::path media_root = "media";
 
-  // Temp for when Transcoding jobs are added
-  std::filesystem::path transcode_output = "media/optimized"; 
+  // Threads doing blocking disk work (cache fills, prefetch) off the I/O threads.
+  uint32_t disk_threads = 4;
+
+  // In-memory head/tail of each file, where container headers live.
+  uint64_t header_cache_budget = 256ull * 1024 * 1024;
+  uint32_t header_cache_head_bytes = 512 * 1024;
+  uint32_t header_cache_tail_bytes = 256 * 1024;
+  bool header_cache_warm_on_scan = false;
+
+  // Decoded keyframe indexes behind /api/media/{id}/seek, built on first use.
+  uint64_t seek_index_cache_budget = 32ull * 1024 * 1024;
+
+  // HLS playlists of fragmented MP4s merge fragments into segments of at
+  // least this length.
+  uint32_t hls_segment_ms = 6000;
+
+  // Shared block cache, used while at least `min_readers` sessions stream
+  // the same file so that their reads are coalesced. 0 budget disables it.
+  uint64_t block_cache_budget = 512ull * 1024 * 1024;
+  uint32_t block_cache_block_size = 1024 * 1024;
+  uint32_t block_cache_min_readers = 2;
+
+  // Per-stream readahead sized from the observed bitrate, plus dropping of
+  // pages far behind the playhead (0 disables dropping).
+  bool readahead_enabled = true;
+  uint32_t readahead_seconds = 20;
+  uint64_t readahead_min_bytes = 2ull * 1024 * 1024;
+  uint64_t readahead_max_bytes = 256ull * 1024 * 1024;
+  uint64_t drop_behind_bytes = 64ull * 1024 * 1024;
+
+  // Stream one-off reads of very large files with O_DIRECT through a pool
+  // of aligned buffers, leaving the page cache to the hot titles. A file
+  // qualifies when it is at least `min_file_size` and was started no more
+  // than `max_recent_plays` times recently (plays decay by half each hour).
+  bool direct_io_enabled = true;
+  uint64_t direct_io_min_file_size = 16ull * 1024 * 1024 * 1024;
+  uint32_t direct_io_max_recent_plays = 1;
+  uint32_t direct_io_buffer_size = 1024 * 1024;
+  uint32_t direct_io_buffer_count = 32;
+
+  // /api/media?limit=&after= pages are capped at `list_page_max` entries;
+  // /api/media?stream=1 writes `list_stream_batch` entries per chunk.
+  uint32_t list_page_max = 1000;
+  uint32_t list_stream_batch = 256;
+
+  // Background jobs (library scans) run on their own low-priority
+  // threads; faststart passes get one more to themselves. The last
+  // `job_history` finished jobs stay queryable.
+  uint32_t job_workers = 1;
+  uint32_t job_history = 64;
+
+  // Library scans walk this many directories in parallel and merge what
+  // they find into the catalog `scan_batch_size` files at a time.
+  uint32_t scan_threads = 8;
+  uint32_t scan_batch_size = 512;
+
+  // Read each new or changed file's container header (duration, codecs,
+  // faststart) while scanning; a handful of small reads per file.
+  bool probe_containers = true;
+
+  // Keep the catalog in step with media_root through inotify instead of
+  // rescans; a changed file is indexed once quiet for `watch_debounce_ms`.
+  bool watch_library = true;
+  uint32_t watch_debounce_ms = 2000;
+
+  // Snapshot of the catalog written after each full scan. At startup it is
+  // served straight away and reconciled by a background scan. Empty path
+  // disables it (the first scan then runs before the server listens).
+  std::filesystem::path catalog_index = ".venturi/catalog.idx";
+
+  // Cache-Control max-age for media responses; ETag/Last-Modified let
+  // clients and proxies revalidate cheaply afterwards.
+  uint32_t media_cache_max_age = 86400;
+
+  // Gzip the cached /api/media body when it is at least this large.
+  bool catalog_gzip = true;
+  uint32_t catalog_gzip_min_bytes = 1024;
+
+  // Where derived copies of titles are written (faststart MP4s for now).
+  // Kept outside media_root so scans do not see them.
+  std::filesystem::path transcode_output = ".venturi/optimized";
+
+  // Rewrite MP4s whose moov trails the media data into faststart copies
+  // under transcode_output, in a background job paced to this rate.
+  bool faststart_enabled = true;
+  uint64_t faststart_max_bytes_per_second = 32ull * 1024 * 1024;
 };
 
 } // namespace venturi
\ No newline at end of file
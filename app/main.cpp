@@ -37,11 +37,17 @@ Version 1.0.0
     LOG_INFO("  Host: ", config.host);
     LOG_INFO("  Port: ", config.port);
     LOG_INFO("  Media Root: ", config.media_root.string());
-    LOG_INFO("  Threads: ", config.thread_count);
+    LOG_INFO("  Threads: ", config.thread_count, config.sharded_io ? " (sharded)" : "");
+    LOG_INFO("  io_uring: ", config.use_io_uring ? "on" : "off");
 
     // Register signal handlers
     std::signal(SIGINT, signal_handler);
     std::signal(SIGTERM, signal_handler);
+#if defined(SIGPIPE)
+    // sendfile(2) has no MSG_NOSIGNAL; a vanished or timed-out client must
+    // surface as EPIPE, not kill the process.
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
 
     // Create application and start services
     venturi::Application app{ config };
@@ -0,0 +1,39 @@
+#include "BenchUtil.hpp"
+
+#include <malloc.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<uint64_t> g_allocations{ 0 };
+std::atomic<int64_t> g_live_bytes{ 0 };
+}
+
+uint64_t venturi::bench::allocation_count() {
+  return g_allocations.load(std::memory_order_relaxed);
+}
+
+int64_t venturi::bench::live_heap_bytes() {
+  return g_live_bytes.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+    g_live_bytes.fetch_add(static_cast<int64_t>(::malloc_usable_size(memory)), std::memory_order_relaxed);
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+  if (memory) {
+    g_live_bytes.fetch_sub(static_cast<int64_t>(::malloc_usable_size(memory)), std::memory_order_relaxed);
+  }
+  std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+  ::operator delete(memory);
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+
+// Minimal micro-benchmark harness; deliberately free of dependencies so the
+// benchmarks build wherever the server does.
+namespace venturi::bench {
+
+// Global operator new calls so far (see AllocationCounter.cpp).
+uint64_t allocation_count();
+
+// Heap bytes currently held through operator new, counting allocator
+// rounding, so before/after differences give real footprints.
+int64_t live_heap_bytes();
+
+// Keeps `value` (and the work producing it) from being optimised away.
+template <typename T>
+inline void do_not_optimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Result {
+  double ns_per_op;
+  double allocations_per_op;
+};
+
+template <typename Fn>
+Result run(std::string_view name, uint64_t iterations, Fn&& fn) {
+  // Warm caches and branch predictors before timing.
+  for (uint64_t i{ 0 }; i < iterations / 10 + 1; ++i) {
+    fn();
+  }
+
+  const uint64_t allocations_before{ allocation_count() };
+  const auto start{ std::chrono::steady_clock::now() };
+
+  for (uint64_t i{ 0 }; i < iterations; ++i) {
+    fn();
+  }
+
+  const auto elapsed{ std::chrono::steady_clock::now() - start };
+  const uint64_t allocations{ allocation_count() - allocations_before };
+
+  Result result{
+    std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations),
+    static_cast<double>(allocations) / static_cast<double>(iterations)
+  };
+
+  std::cout << std::left << std::setw(44) << name
+            << std::right << std::setw(12) << std::fixed << std::setprecision(1)
+            << result.ns_per_op << " ns/op"
+            << std::setw(10) << std::setprecision(2)
+            << result.allocations_per_op << " allocs/op" << std::endl;
+
+  return result;
+}
+
+} // namespace venturi::bench
@@ -0,0 +1,172 @@
+#include "BenchUtil.hpp"
+#include "entities/MediaList.hpp"
+#include "storage/CatalogSnapshot.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace venturi;
+
+namespace {
+
+constexpr std::size_t entry_count{ 100'000 };
+
+// The entry and containers the repository used before the compact layout:
+// string id, mime and ETag per entry, one map node per entry keyed by id,
+// and a second tree keyed by path for ordered listings.
+struct LegacyMediaInfo {
+  std::string id;
+  std::filesystem::path file_path;
+  std::filesystem::path optimized_path;
+  std::string mime_type;
+  std::chrono::system_clock::time_point created_at;
+  std::chrono::system_clock::time_point modified_at;
+  uint64_t inode{ 0 };
+  uint64_t file_size{ 0 };
+  std::string etag;
+};
+
+struct LegacyCatalog {
+  std::unordered_map<std::string, LegacyMediaInfo> media_map;
+  std::map<std::filesystem::path, std::string> path_index;
+};
+
+std::string library_path(std::size_t i) {
+  char path[128];
+  std::snprintf(path, sizeof(path), "/srv/media/Series %04zu/Season %02zu/Episode %03zu - Title.mkv",
+    i / 200, i / 20 % 10, i % 20);
+  return path;
+}
+
+LegacyCatalog build_legacy(const std::vector<std::string>& paths) {
+  LegacyCatalog catalog;
+  for (std::size_t i{ 0 }; i < paths.size(); ++i) {
+    LegacyMediaInfo info;
+    char id[17];
+    std::snprintf(id, sizeof(id), "%016zx", std::hash<std::string>{}(paths[i]));
+    info.id = id;
+    info.file_path = paths[i];
+    info.mime_type = "video/x-matroska";
+    info.inode = i + 1;
+    info.file_size = 1'000'000'000 + i;
+
+    char etag[64];
+    std::snprintf(etag, sizeof(etag), "\"%" PRIx64 "-%" PRIx64 "-%" PRIx64 "\"",
+      info.inode, info.file_size, uint64_t{ 1'700'000'000'000'000'000 } + i);
+    info.etag = etag;
+
+    catalog.path_index.emplace(info.file_path, info.id);
+    catalog.media_map.emplace(info.id, std::move(info));
+  }
+  return catalog;
+}
+
+std::shared_ptr<const adapters::CatalogSnapshot> build_compact(const std::vector<std::string>& paths) {
+  adapters::CatalogSnapshot::Handles media;
+  media.reserve(paths.size());
+  for (std::size_t i{ 0 }; i < paths.size(); ++i) {
+    core::MediaInfo info;
+    info.id = core::MediaId::from_relative_path(std::string_view(paths[i]).substr(11));
+    info.file_path = paths[i];
+    info.mime_type = core::MimeType::matroska;
+    info.inode = i + 1;
+    info.file_size = 1'000'000'000 + i;
+    media.push_back(std::make_shared<const core::MediaInfo>(std::move(info)));
+  }
+  return adapters::CatalogSnapshot::build(std::move(media), 1);
+}
+
+void report_footprint(std::string_view name, int64_t bytes) {
+  std::cout << std::left << std::setw(44) << name
+            << std::right << std::setw(12) << std::fixed << std::setprecision(1)
+            << static_cast<double>(bytes) / entry_count << " bytes/entry" << std::endl;
+}
+
+} // namespace
+
+int main() {
+  std::vector<std::string> paths;
+  paths.reserve(entry_count);
+  for (std::size_t i{ 0 }; i < entry_count; ++i) {
+    paths.push_back(library_path(i));
+  }
+
+  std::cout << "Catalog layout (" << entry_count << " entries)\n\n";
+
+  auto before{ bench::live_heap_bytes() };
+  auto legacy{ build_legacy(paths) };
+  report_footprint("legacy  footprint", bench::live_heap_bytes() - before);
+
+  before = bench::live_heap_bytes();
+  auto compact{ build_compact(paths) };
+  report_footprint("compact footprint", bench::live_heap_bytes() - before);
+
+  std::cout << '\n';
+
+  // list_all(): the legacy repository copied every entry and sorted the
+  // copies; the compact one hands out a view of the path-ordered handles.
+  bench::run("legacy  list_all + walk", 5, [&] {
+    std::vector<LegacyMediaInfo> result;
+    result.reserve(legacy.media_map.size());
+    for (const auto& [id, info] : legacy.media_map) {
+      result.push_back(info);
+    }
+    std::sort(result.begin(), result.end(),
+      [](const auto& a, const auto& b) { return a.file_path < b.file_path; });
+
+    std::size_t bytes{ 0 };
+    for (const auto& info : result) {
+      bytes += info.file_path.native().size() + info.mime_type.size();
+    }
+    bench::do_not_optimize(bytes);
+  });
+
+  bench::run("compact list_all + walk", 5, [&] {
+    core::MediaList result{ compact, compact->entries() };
+
+    std::size_t bytes{ 0 };
+    for (const auto& info : result) {
+      bytes += info.file_path.size() + core::to_string(info.mime_type).size();
+    }
+    bench::do_not_optimize(bytes);
+  });
+
+  std::cout << '\n';
+
+  std::vector<std::string> legacy_ids;
+  std::vector<std::string> compact_ids;
+  for (std::size_t i{ 0 }; i < entry_count; i += 97) {
+    char id[17];
+    std::snprintf(id, sizeof(id), "%016zx", std::hash<std::string>{}(paths[i]));
+    legacy_ids.emplace_back(id);
+    compact_ids.push_back(core::MediaId::from_relative_path(std::string_view(paths[i]).substr(11)).to_string());
+  }
+
+  // Lookups start from the id in the request target.
+  std::size_t next{ 0 };
+  bench::run("legacy  find_by_id (copy)", 1'000'000, [&] {
+    std::string_view target{ legacy_ids[next++ % legacy_ids.size()] };
+    auto it = legacy.media_map.find(std::string(target));
+    std::optional<LegacyMediaInfo> found;
+    if (it != legacy.media_map.end()) {
+      found = it->second;
+    }
+    bench::do_not_optimize(found);
+  });
+
+  next = 0;
+  bench::run("compact find_by_id (handle)", 1'000'000, [&] {
+    auto id = core::MediaId::parse(compact_ids[next++ % compact_ids.size()]);
+    auto found = compact->find_by_id(*id);
+    bench::do_not_optimize(found);
+  });
+
+  return 0;
+}
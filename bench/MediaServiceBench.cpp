@@ -0,0 +1,88 @@
+#include "BenchUtil.hpp"
+#include "ports/AnyMediaRepository.hpp"
+#include "storage/FileSystemMediaService.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace venturi;
+
+namespace {
+
+constexpr std::size_t file_count{ 10'000 };
+constexpr uint64_t iterations{ 5'000'000 };
+
+// A throwaway library of empty files, scanned once; probing is off, so
+// nothing but the catalog is exercised afterwards.
+std::filesystem::path make_library() {
+  auto root{ std::filesystem::temp_directory_path() / "venturi-bench-media-service" };
+  std::filesystem::remove_all(root);
+  std::filesystem::create_directories(root);
+
+  for (std::size_t i{ 0 }; i < file_count; ++i) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "title-%05zu.mkv", i);
+    std::ofstream{ root / name };
+  }
+  return root;
+}
+
+// The calls a media request makes into the service before any I/O: the
+// lookup, plus the generation check the catalog cache does per listing.
+template <typename Service>
+void run_request_path(const char* label, Service& service, const std::vector<core::MediaId>& ids) {
+  std::size_t next{ 0 };
+  auto pick = [&] {
+    next = next + 1 == ids.size() ? 0 : next + 1;
+    return ids[next];
+  };
+
+  std::cout << label << '\n';
+  bench::run("  get_media", iterations, [&] {
+    bench::do_not_optimize(service.get_media(pick()));
+  });
+  bench::run("  catalog_generation", iterations, [&] {
+    bench::do_not_optimize(service.catalog_generation());
+  });
+  bench::run("  get_media + catalog_generation", iterations, [&] {
+    bench::do_not_optimize(service.get_media(pick()));
+    bench::do_not_optimize(service.catalog_generation());
+  });
+  std::cout << '\n';
+}
+
+} // namespace
+
+int main() {
+  auto root{ make_library() };
+
+  auto repository{ std::make_shared<adapters::FileSystemRepository>(
+    root, std::filesystem::path{}, adapters::ParallelScanner::Options{}, std::filesystem::path{}, false
+  ) };
+  repository->scan_directory(root, {});
+
+  std::vector<core::MediaId> ids;
+  for (const auto& media : repository->list_all()) {
+    ids.push_back(media.id);
+  }
+
+  std::cout << "MediaService request path (" << ids.size() << " titles, "
+            << iterations << " iterations per case)\n\n";
+
+  // Bound at compile time: the repository calls inline into the service.
+  adapters::MediaService direct{ repository };
+  run_request_path("MediaService<FileSystemRepository>", direct, ids);
+
+  // The same repository behind one virtual call per operation.
+  core::MediaService<core::AnyMediaRepository> erased{
+    std::make_shared<core::AnyMediaRepository>(repository)
+  };
+  run_request_path("MediaService<AnyMediaRepository>", erased, ids);
+
+  std::filesystem::remove_all(root);
+  return 0;
+}
@@ -0,0 +1,152 @@
+#include "BenchUtil.hpp"
+#include "../core/services/RangeParser.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <regex>
+#include <string>
+#include <vector>
+
+using namespace venturi;
+
+namespace {
+
+// The std::regex parser this replaced (MediaService::parse_range_header
+// and coalesce_ranges after multi-range support), kept verbatim as the
+// baseline.
+constexpr std::size_t max_range_specs{ 64 };
+
+std::vector<core::ByteRange> coalesce_ranges(
+  std::vector<core::ByteRange> ranges
+) {
+  std::sort(ranges.begin(), ranges.end(),
+    [](const core::ByteRange& a, const core::ByteRange& b) {
+      return a.start < b.start;
+    });
+
+  std::vector<core::ByteRange> merged;
+  merged.reserve(ranges.size());
+
+  for (const auto& range : ranges) {
+    // Overlapping or directly adjacent ranges become one part.
+    if (!merged.empty() && range.start <= merged.back().end + 1) {
+      merged.back().end = std::max(merged.back().end, range.end);
+    } else {
+      merged.push_back(range);
+    }
+  }
+
+  return merged;
+}
+
+std::optional<std::vector<core::ByteRange>> parse_with_regex(
+  const std::string& range_header,
+  uint64_t file_size
+) {
+  static const std::regex unit_regex(
+    R"(\s*bytes\s*=(.*))",
+    std::regex::icase
+  );
+  static const std::regex spec_regex(
+    R"(\s*(\d*)-(\d*)\s*)"
+  );
+
+  std::smatch unit_match;
+  if (!std::regex_match(range_header, unit_match, unit_regex)) {
+    return std::nullopt;
+  }
+
+  const std::string specs{ unit_match[1].str() };
+  std::vector<core::ByteRange> ranges;
+  std::size_t spec_count{ 0 };
+
+  std::size_t pos{ 0 };
+  while (pos <= specs.size()) {
+    std::size_t comma{ specs.find(',', pos) };
+    if (comma == std::string::npos) {
+      comma = specs.size();
+    }
+
+    const std::string spec{ specs.substr(pos, comma - pos) };
+    pos = comma + 1;
+
+    if (++spec_count > max_range_specs) {
+      return std::nullopt;
+    }
+
+    std::smatch matches;
+    if (!std::regex_match(spec, matches, spec_regex)) {
+      return std::nullopt;
+    }
+
+    const std::string start_str = matches[1].str();
+    const std::string end_str = matches[2].str();
+
+    if (start_str.empty() && end_str.empty()) {
+      return std::nullopt;
+    }
+
+    core::ByteRange range;
+    range.total_size = file_size;
+
+    if (start_str.empty()) {
+      uint64_t suffix_length = std::stoull(end_str);
+      if (suffix_length == 0 || file_size == 0) {
+        continue;
+      }
+      range.start = file_size > suffix_length ?
+        file_size - suffix_length : 0;
+      range.end = file_size - 1;
+    } else {
+      range.start = std::stoull(start_str);
+      range.end = end_str.empty() ?
+        file_size - 1 : std::stoull(end_str);
+    }
+
+    // Unsatisfiable specs are skipped as long as another one is usable.
+    if (range.is_valid()) {
+      ranges.push_back(range);
+    }
+  }
+
+  if (ranges.empty()) {
+    return std::nullopt;
+  }
+
+  return coalesce_ranges(std::move(ranges));
+}
+
+} // namespace
+
+int main() {
+  constexpr uint64_t file_size{ 42'000'000'000ULL };
+  constexpr uint64_t iterations{ 1'000'000 };
+
+  // Typical scrubbing traffic: open-ended seeks, bounded chunks, suffixes.
+  const std::vector<std::string> headers{
+    "bytes=0-",
+    "bytes=1048576-",
+    "bytes=31457280-32505855",
+    "bytes=-1048576",
+    "bytes=20000000000-20001048575",
+    // Multi-range: overlapping specs that coalesce, and six disjoint chunks.
+    "bytes=0-1023, 4096-8191, 2048-4095, -65536",
+    "bytes=0-65535,1048576-2097151,4194304-5242879,8388608-9437183,16777216-17825791,33554432-",
+  };
+
+  std::cout << "Range header parsing (" << iterations << " iterations per case)\n\n";
+
+  for (const auto& header : headers) {
+    bench::run("regex   " + header, iterations, [&] {
+      bench::do_not_optimize(parse_with_regex(header, file_size));
+    });
+
+    bench::run("parser  " + header, iterations, [&] {
+      core::ByteRangeSet ranges;
+      bench::do_not_optimize(core::parse_byte_ranges(header, file_size, ranges));
+      bench::do_not_optimize(ranges);
+    });
+  }
+
+  return 0;
+}
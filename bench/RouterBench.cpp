@@ -0,0 +1,85 @@
+#include "BenchUtil.hpp"
+#include "http/Router.hpp"
+
+#include <array>
+#include <string>
+#include <vector>
+
+using namespace venturi;
+using adapters::http::verb;
+
+namespace {
+
+enum class Endpoint {
+  none,
+  list_media,
+  get_media,
+  scan,
+};
+
+struct LegacyMatch {
+  Endpoint endpoint{ Endpoint::none };
+  std::string media_id;
+};
+
+// The string-copying dispatch HttpSession::handle_request used before the
+// route table, reduced to what it decided.
+LegacyMatch dispatch_legacy(verb method, std::string_view raw_target) {
+  std::string target{ std::string(raw_target) };
+
+  if (method == verb::get) {
+    if (target == "/api/media") {
+      return { Endpoint::list_media, {} };
+    }
+
+    else if (target.starts_with("/api/media/")) {
+      std::string media_id{ target.substr(11) };
+
+      if (std::size_t pos{ media_id.find('?') }; pos != std::string::npos) {
+        media_id = media_id.substr(0, pos);
+      }
+
+      return { Endpoint::get_media, media_id };
+    }
+
+    else if (target == "/api/scan") {
+      return { Endpoint::scan, {} };
+    }
+  }
+
+  return {};
+}
+
+constexpr adapters::Router routes{ std::array{
+  adapters::Route{ verb::get, "/api/media",      Endpoint::list_media },
+  adapters::Route{ verb::get, "/api/media/{id}", Endpoint::get_media },
+  adapters::Route{ verb::get, "/api/scan",       Endpoint::scan },
+} };
+
+} // namespace
+
+int main() {
+  constexpr uint64_t iterations{ 2'000'000 };
+
+  const std::vector<std::string> targets{
+    "/api/media",
+    "/api/media/3f9a1c0b7e2d4a6f8b1c2d3e4f5a6b7c",
+    "/api/media/3f9a1c0b7e2d4a6f8b1c2d3e4f5a6b7c?t=1234",
+    "/api/scan",
+    "/favicon.ico",
+  };
+
+  std::cout << "Request dispatch (" << iterations << " iterations per case)\n\n";
+
+  for (const auto& target : targets) {
+    bench::run("legacy  " + target, iterations, [&] {
+      bench::do_not_optimize(dispatch_legacy(verb::get, target));
+    });
+
+    bench::run("router  " + target, iterations, [&] {
+      bench::do_not_optimize(routes.match(verb::get, target));
+    });
+  }
+
+  return 0;
+}
@@ -0,0 +1,46 @@
+#include "../core/services/RangeParser.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+using namespace venturi;
+
+// Feeds arbitrary bytes to the Range parser and checks the invariants every
+// caller relies on: ranges are in bounds, ascending and never overlap or
+// touch, and the status agrees with the output.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size) {
+  // First 8 bytes pick the file size, the rest is the header value.
+  uint64_t file_size{ 0 };
+  if (size >= sizeof(file_size)) {
+    std::memcpy(&file_size, data, sizeof(file_size));
+    data += sizeof(file_size);
+    size -= sizeof(file_size);
+  }
+
+  std::string_view value{ reinterpret_cast<const char*>(data), size };
+
+  core::ByteRangeSet ranges;
+  auto status = core::parse_byte_ranges(value, file_size, ranges);
+
+  if ((status == core::RangeParseStatus::ok) != !ranges.empty()) {
+    __builtin_trap();
+  }
+  if (ranges.size() > core::ByteRangeSet::capacity) {
+    __builtin_trap();
+  }
+
+  const core::ByteRange* previous{ nullptr };
+  for (const auto& range : ranges) {
+    if (!range.is_valid() || range.total_size != file_size) {
+      __builtin_trap();
+    }
+    if (previous && previous->end + 1 >= range.start) {
+      __builtin_trap();
+    }
+    previous = &range;
+  }
+
+  return 0;
+}
@@ -3,13 +3,62 @@
 
 #include "../../../app/Logger.hpp"
 
+#include <algorithm>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#endif
+
 namespace venturi::adapters {
 
+namespace {
+
+#if defined(__linux__)
+using reuse_port = asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+
+// Pins the calling thread to the n-th CPU it is allowed to run on.
+void pin_current_thread(uint32_t n) {
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+    return;
+  }
+
+  int count{ CPU_COUNT(&allowed) };
+  if (count == 0) {
+    return;
+  }
+
+  int target{ static_cast<int>(n % static_cast<uint32_t>(count)) };
+  for (int cpu{ 0 }; cpu < CPU_SETSIZE; ++cpu) {
+    if (!CPU_ISSET(cpu, &allowed) || target-- > 0) {
+      continue;
+    }
+
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(cpu, &mask);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) != 0) {
+      LOG_WARN("Failed to pin I/O thread to CPU ", cpu);
+    }
+    return;
+  }
+}
+#endif
+
+} // namespace
+
 BeastHttpServer::BeastHttpServer(
-  std::shared_ptr<core::MediaService>   media_service,
+  std::shared_ptr<MediaService>         media_service,
+  std::shared_ptr<MediaReader>          media_reader,
+  std::shared_ptr<CatalogCache>         catalog_cache,
   const Config&                         config
 ) 
   : media_service_(std::move(media_service))
+  , media_reader_(std::move(media_reader))
+  , catalog_cache_(std::move(catalog_cache))
   , config_(config)
 {}
 
@@ -30,30 +79,82 @@ void BeastHttpServer::start(
   try {
     asio::ip::address const address{ asio::ip::make_address(host) };
     tcp::endpoint endpoint{ address, port };
-    
-    acceptor_ = std::make_unique<tcp::acceptor>(ioc_);
-    acceptor_->open(endpoint.protocol());
-    acceptor_->set_option(asio::socket_base::reuse_address(true));
-    acceptor_->bind(endpoint);
-    acceptor_->listen(asio::socket_base::max_listen_connections);
-    
+
+    thread_count = std::max<uint32_t>(thread_count, 1);
+
+#if defined(__linux__)
+    const bool sharded{ config_.sharded_io };
+#else
+    const bool sharded{ false };
+    if (config_.sharded_io) {
+      LOG_WARN("Sharded I/O needs SO_REUSEPORT; using a shared io_context");
+    }
+#endif
+
+    const uint32_t shard_count{ sharded ? thread_count : 1 };
+    const uint32_t accepts{ sharded ? std::max<uint32_t>(config_.accepts_per_shard, 1) : 1 };
+
+    const bool use_io_uring{ config_.use_io_uring && IoUringEngine::is_available() };
+    if (config_.use_io_uring && !use_io_uring) {
+      LOG_WARN("io_uring unavailable, falling back to sendfile");
+    }
+
+    shards_.reserve(shard_count);
+    for (uint32_t i{ 0 }; i < shard_count; ++i) {
+      auto shard{ std::make_unique<Shard>(sharded ? 1 : static_cast<int>(thread_count)) };
+      shard->strand_per_session = !sharded;
+
+      this->open_acceptor(*shard, endpoint, sharded);
+
+      if (use_io_uring) {
+        IoUringEngine::Options options;
+        options.queue_depth = config_.io_uring_queue_depth;
+        try {
+          shard->io_engine = std::make_unique<IoUringEngine>(shard->ioc, options);
+        } catch (const std::exception& e) {
+          LOG_WARN(e.what(), ", shard falls back to sendfile");
+        }
+      }
+
+      for (uint32_t a{ 0 }; a < accepts; ++a) {
+        this->do_accept(*shard);
+      }
+
+      shards_.push_back(std::move(shard));
+    }
+
     LOG_INFO("Server listening on ", host, ":", port);
-    
-    this->do_accept();
+    if (use_io_uring && shards_.front()->io_engine) {
+      LOG_INFO("Streaming through io_uring");
+    }
     
     threads_.reserve(thread_count);
     for (uint32_t i{ 0 }; i < thread_count; ++i) {
-      // Each thread will process async events by calling ioc_.run().
-      threads_.emplace_back([this] {
-        ioc_.run();
+      Shard& shard{ *shards_[sharded ? i : 0] };
+
+      // Each thread will process async events by calling run() on its shard.
+      threads_.emplace_back([&shard, i, sharded, pin = config_.pin_io_threads] {
+#if defined(__linux__)
+        if (sharded && pin) {
+          pin_current_thread(i);
+        }
+#else
+        (void)i; (void)sharded; (void)pin;
+#endif
+        shard.ioc.run();
       });
     }
     
-    LOG_INFO("Server started with ", thread_count, " threads");
+    if (sharded) {
+      LOG_INFO("Server started with ", thread_count, " sharded threads");
+    } else {
+      LOG_INFO("Server started with ", thread_count, " threads");
+    }
       
   } catch (const std::exception& ex) {
     LOG_ERROR("Failed to start server: ", ex.what());
     running_ = false;
+    shards_.clear();
     throw;
   }
 }
@@ -65,13 +166,15 @@ void BeastHttpServer::stop() {
   
   LOG_INFO("Stopping server...");
   
-  if (acceptor_) {
-    beast::error_code ec;
-    acceptor_->close(ec);
+  for (auto& shard : shards_) {
+    if (shard->acceptor) {
+      beast::error_code ec;
+      shard->acceptor->close(ec);
+    }
+
+    shard->ioc.stop();
   }
   
-  ioc_.stop();
-  
   for (auto& thread : threads_) {
     if (thread.joinable()) {
       thread.join();
@@ -79,22 +182,49 @@ void BeastHttpServer::stop() {
   }
   
   threads_.clear();
+  shards_.clear();
   LOG_INFO("Server stopped successfully.");
 }
 
 bool BeastHttpServer::is_running() const { return running_; }
 
-void BeastHttpServer::do_accept() {
-  acceptor_->async_accept(
-    asio::make_strand(ioc_),
-    beast::bind_front_handler(
-      &BeastHttpServer::on_accept,
-      this
-    )
-  );
+void BeastHttpServer::open_acceptor(
+  Shard&                shard,
+  const tcp::endpoint&  endpoint,
+  bool                  reuse_port_enabled
+) {
+  shard.acceptor = std::make_unique<tcp::acceptor>(shard.ioc);
+  shard.acceptor->open(endpoint.protocol());
+  shard.acceptor->set_option(asio::socket_base::reuse_address(true));
+#if defined(__linux__)
+  if (reuse_port_enabled) {
+    // The kernel load-balances new connections across the shards' acceptors.
+    shard.acceptor->set_option(reuse_port(true));
+  }
+#else
+  (void)reuse_port_enabled;
+#endif
+  shard.acceptor->bind(endpoint);
+  shard.acceptor->listen(asio::socket_base::max_listen_connections);
+}
+
+void BeastHttpServer::do_accept(Shard& shard) {
+  auto handler{ beast::bind_front_handler(
+    &BeastHttpServer::on_accept,
+    this,
+    std::ref(shard)
+  ) };
+
+  if (shard.strand_per_session) {
+    shard.acceptor->async_accept(asio::make_strand(shard.ioc), std::move(handler));
+  } else {
+    // A shard is single-threaded, so its sessions need no strand.
+    shard.acceptor->async_accept(shard.ioc, std::move(handler));
+  }
 }
 
 void BeastHttpServer::on_accept(
+  Shard&            shard,
   beast::error_code ec,
   tcp::socket       socket
 ) {
@@ -107,14 +237,17 @@ void BeastHttpServer::on_accept(
     std::make_shared<HttpSession>(
       std::move(socket),
       media_service_,
-      config_
+      media_reader_,
+      catalog_cache_,
+      config_,
+      shard.io_engine.get()
     )->run();
   }
   
   // Accept next connection
   if (running_) {
-    this->do_accept();
+    this->do_accept(shard);
   }
 }
 
-} // namespace venturi::adapters
\ No newline at end of file
+} // namespace venturi::adapters
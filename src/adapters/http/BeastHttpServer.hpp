@@ -1,7 +1,10 @@
 #pragma once
-#include "../../core/ports/IHttpServer.hpp"
-#include "../../core/services/MediaService.hpp"
+#include "../../core/ports/HttpServer.hpp"
+#include "../storage/FileSystemMediaService.hpp"
 #include "../../../app/Config.hpp"
+#include "../storage/MediaReader.hpp"
+#include "CatalogCache.hpp"
+#include "IoUringEngine.hpp"
 
 #include <boost/asio.hpp>
 #include <boost/beast.hpp>
@@ -16,34 +19,54 @@ namespace http = beast::http;
 namespace asio = boost::asio;
 using tcp = asio::ip::tcp;
 
-class BeastHttpServer : public core::IHttpServer {
+class BeastHttpServer {
 public:
   BeastHttpServer(
-    std::shared_ptr<core::MediaService>   media_service,
+    std::shared_ptr<MediaService>         media_service,
+    std::shared_ptr<MediaReader>          media_reader,
+    std::shared_ptr<CatalogCache>         catalog_cache,
     const Config&                         config
   );
   
-  ~BeastHttpServer() override;
+  ~BeastHttpServer();
   
   void start(
     const std::string&  host,
     uint16_t            port,
     uint32_t            thread_count
-  ) override;
+  );
   
-  void stop() override;
-  bool is_running() const override;
+  void stop();
+  bool is_running() const;
 
 private:
-  void do_accept();
-  void on_accept(beast::error_code ec, tcp::socket socket);
+  // An io_context with its own acceptor. In the default mode there is one
+  // shard run by every thread, with a strand per session. In sharded mode
+  // (Config::sharded_io) each thread owns a shard outright, pinned to a CPU
+  // and listening on the same port through SO_REUSEPORT, so a connection
+  // never leaves the core that accepted it.
+  struct Shard {
+    explicit Shard(int concurrency_hint) : ioc(concurrency_hint) {}
+
+    asio::io_context ioc;
+    std::unique_ptr<tcp::acceptor> acceptor;
+    std::unique_ptr<IoUringEngine> io_engine;
+    bool strand_per_session{ true };
+  };
 
-  std::shared_ptr<core::MediaService> media_service_;
+  void open_acceptor(Shard& shard, const tcp::endpoint& endpoint, bool reuse_port);
+  void do_accept(Shard& shard);
+  void on_accept(Shard& shard, beast::error_code ec, tcp::socket socket);
+
+  std::shared_ptr<MediaService> media_service_;
+  std::shared_ptr<MediaReader> media_reader_;
+  std::shared_ptr<CatalogCache> catalog_cache_;
   const Config& config_;
-  asio::io_context ioc_;
-  std::unique_ptr<tcp::acceptor> acceptor_;
+  std::vector<std::unique_ptr<Shard>> shards_;
   std::vector<std::thread> threads_;
   std::atomic<bool> running_{ false };
 };
 
-} // namespace venturi::adapters
\ No newline at end of file
+static_assert(core::HttpServer<BeastHttpServer>);
+
+} // namespace venturi::adapters
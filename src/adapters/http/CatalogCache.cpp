@@ -0,0 +1,147 @@
+#include "CatalogCache.hpp"
+#include "CatalogJson.hpp"
+#include "../../core/entities/MediaId.hpp"
+#include "../../../app/Logger.hpp"
+
+#include <boost/beast/zlib/deflate_stream.hpp>
+#include <array>
+#include <cinttypes>
+#include <cstdio>
+#include <string_view>
+
+namespace venturi::adapters {
+
+namespace zlib = boost::beast::zlib;
+
+namespace {
+
+constexpr std::array<uint32_t, 256> crc32_table{ [] {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i{ 0 }; i < table.size(); ++i) {
+    uint32_t c{ i };
+    for (int bit{ 0 }; bit < 8; ++bit) {
+      c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+    }
+    table[i] = c;
+  }
+  return table;
+}() };
+
+uint32_t crc32(std::string_view data) {
+  uint32_t crc{ 0xFFFFFFFFu };
+  for (unsigned char byte : data) {
+    crc = crc32_table[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+  }
+  return crc ^ 0xFFFFFFFFu;
+}
+
+void append_le32(std::string& out, uint32_t value) {
+  for (int i{ 0 }; i < 4; ++i) {
+    out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+  }
+}
+
+// Wraps Beast's bundled deflate in a gzip member (RFC 1952), so no zlib
+// dependency is needed. Returns an empty string on failure.
+std::string gzip(std::string_view input) {
+  zlib::deflate_stream stream;
+  stream.reset(6, 15, 8, zlib::Strategy::normal);
+
+  std::string out{ "\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\x03", 10 };
+  const std::size_t header_size{ out.size() };
+  out.resize(header_size + stream.upper_bound(input.size()));
+
+  zlib::z_params params;
+  params.next_in = input.data();
+  params.avail_in = input.size();
+  params.next_out = out.data() + header_size;
+  params.avail_out = out.size() - header_size;
+
+  boost::system::error_code ec;
+  stream.write(params, zlib::Flush::finish, ec);
+  if (ec && ec != zlib::error::end_of_stream) {
+    LOG_WARN("Catalog compression failed: ", ec.message());
+    return {};
+  }
+  if (params.avail_in != 0) {
+    return {};
+  }
+
+  out.resize(header_size + params.total_out);
+  append_le32(out, crc32(input));
+  append_le32(out, static_cast<uint32_t>(input.size()));
+  return out;
+}
+
+std::string serialize(const core::MediaList& media_list) {
+  std::string json;
+  json.reserve(64 + media_list.size() * 128);
+  json += "{\"media\":[";
+
+  for (std::size_t i{ 0 }; i < media_list.size(); ++i) {
+    if (i > 0) json += ',';
+    append_media_json(json, media_list[i]);
+  }
+
+  json += "]}";
+  return json;
+}
+
+} // namespace
+
+CatalogCache::CatalogCache(
+  std::shared_ptr<MediaService>         media_service,
+  const Config&                         config
+)
+  : media_service_(std::move(media_service))
+  , compress_(config.catalog_gzip)
+  , compress_min_bytes_(config.catalog_gzip_min_bytes)
+{}
+
+std::shared_ptr<const CatalogCache::Body> CatalogCache::current() {
+  const uint64_t generation{ media_service_->catalog_generation() };
+
+  // A body built after this caller read the generation is newer still,
+  // which is just as good.
+  auto body{ body_.load(std::memory_order_acquire) };
+  if (body && body->generation >= generation) {
+    return body;
+  }
+
+  std::lock_guard lock(rebuild_mutex_);
+  body = body_.load(std::memory_order_acquire);
+  if (!body || body->generation < generation) {
+    body = this->build(generation);
+    body_.store(body, std::memory_order_release);
+  }
+  return body;
+}
+
+std::shared_ptr<const CatalogCache::Body> CatalogCache::build(uint64_t generation) const {
+  // The generation is read before listing, so a change racing with the
+  // rebuild only ever makes the body newer than its tag, never older.
+  auto body{ std::make_shared<Body>() };
+  body->generation = generation;
+  body->json = serialize(media_service_->list_all_media());
+
+  // Stable across builds and standard libraries, unlike std::hash.
+  char etag[19];
+  std::snprintf(etag, sizeof(etag), "\"%016" PRIx64 "\"", core::xxh64(body->json.data(), body->json.size()));
+  body->etag = etag;
+
+  if (compress_ && body->json.size() >= compress_min_bytes_) {
+    body->gzip = gzip(body->json);
+    if (body->gzip.size() >= body->json.size()) {
+      body->gzip.clear();
+    } else {
+      body->gzip_etag = body->etag;
+      body->gzip_etag.insert(body->gzip_etag.size() - 1, "-gz");
+    }
+  }
+
+  LOG_DEBUG("Catalog generation ", generation, ": ", body->json.size(), " bytes, ",
+            body->gzip.size(), " gzipped");
+  return body;
+}
+
+} // namespace venturi::adapters
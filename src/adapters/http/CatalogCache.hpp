@@ -0,0 +1,45 @@
+#pragma once
+#include "../storage/FileSystemMediaService.hpp"
+#include "../../../app/Config.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace venturi::adapters {
+
+// Serialized /api/media listing, rebuilt only when the catalog generation
+// changes. Bodies are immutable and shared, so every request for the same
+// generation writes the same buffer.
+class CatalogCache {
+public:
+  struct Body {
+    uint64_t generation{ 0 };
+    std::string etag;        // strong, quoted; XXH64 of the JSON bytes
+    std::string json;
+    std::string gzip_etag;   // distinct tag for the gzip representation
+    std::string gzip;        // empty when compression is off or does not pay
+  };
+
+  CatalogCache(
+    std::shared_ptr<MediaService>         media_service,
+    const Config&                         config
+  );
+
+  // The body for the current generation. Hits are a single atomic load;
+  // concurrent callers after a change wait for a single rebuild instead of
+  // each doing their own.
+  std::shared_ptr<const Body> current();
+
+private:
+  std::shared_ptr<const Body> build(uint64_t generation) const;
+
+  std::shared_ptr<MediaService> media_service_;
+  bool compress_;
+  std::size_t compress_min_bytes_;
+
+  std::atomic<std::shared_ptr<const Body>> body_;
+  std::mutex rebuild_mutex_;
+};
+
+} // namespace venturi::adapters
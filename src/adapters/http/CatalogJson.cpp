@@ -0,0 +1,81 @@
+#include "CatalogJson.hpp"
+#include <cstdio>
+
+namespace venturi::adapters {
+
+namespace {
+
+constexpr char hex_digits[]{ "0123456789abcdef" };
+
+int hex_value(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+} // namespace
+
+void append_json_string(std::string& out, std::string_view value) {
+  out.push_back('"');
+  for (unsigned char c : value) {
+    switch (c) {
+      case '"':  out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if (c < 0x20) {
+          char escaped[7];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+          out += escaped;
+        } else {
+          out.push_back(static_cast<char>(c));
+        }
+    }
+  }
+  out.push_back('"');
+}
+
+void append_media_json(std::string& out, const core::MediaInfo& media) {
+  auto id{ media.id.hex() };
+  out += "{\"id\":\"";
+  out.append(id.data(), id.size());
+  out += '"';
+  out += ",\"path\":";
+  append_json_string(out, media.file_path);
+  out += ",\"mime\":";
+  append_json_string(out, core::to_string(media.mime_type));
+  out += '}';
+}
+
+std::string encode_cursor(std::string_view path) {
+  std::string cursor;
+  cursor.reserve(path.size() * 2);
+  for (unsigned char c : path) {
+    cursor.push_back(hex_digits[c >> 4]);
+    cursor.push_back(hex_digits[c & 0x0F]);
+  }
+  return cursor;
+}
+
+std::optional<std::filesystem::path> decode_cursor(std::string_view cursor) {
+  if (cursor.size() % 2 != 0) {
+    return std::nullopt;
+  }
+
+  std::string native;
+  native.reserve(cursor.size() / 2);
+  for (std::size_t i{ 0 }; i < cursor.size(); i += 2) {
+    int high{ hex_value(cursor[i]) };
+    int low{ hex_value(cursor[i + 1]) };
+    if (high < 0 || low < 0) {
+      return std::nullopt;
+    }
+    native.push_back(static_cast<char>(high << 4 | low));
+  }
+  return std::filesystem::path(std::move(native));
+}
+
+} // namespace venturi::adapters
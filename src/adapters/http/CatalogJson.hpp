@@ -0,0 +1,21 @@
+#pragma once
+#include "../../core/entities/MediaInfo.hpp"
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace venturi::adapters {
+
+// Appends `value` as a quoted, escaped JSON string.
+void append_json_string(std::string& out, std::string_view value);
+
+// Appends the listing object for one title: {"id":..,"path":..,"mime":..}.
+void append_media_json(std::string& out, const core::MediaInfo& media);
+
+// Listing cursors are the sort key (the file path), hex-encoded so they
+// survive a query string untouched. Clients treat them as opaque.
+std::string encode_cursor(std::string_view path);
+std::optional<std::filesystem::path> decode_cursor(std::string_view cursor);
+
+} // namespace venturi::adapters
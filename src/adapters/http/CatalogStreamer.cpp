@@ -0,0 +1,122 @@
+#include "CatalogStreamer.hpp"
+#include "CatalogJson.hpp"
+
+namespace venturi::adapters {
+
+namespace {
+
+// Every write gets this long; a client that stops reading is dropped.
+constexpr std::chrono::seconds write_timeout{ 30 };
+
+} // namespace
+
+CatalogStreamer::CatalogStreamer(
+  beast::tcp_stream&                    stream,
+  std::shared_ptr<MediaService>         media_service,
+  unsigned                              version,
+  bool                                  keep_alive,
+  std::size_t                           batch_size
+)
+  : stream_(stream)
+  , media_service_(std::move(media_service))
+  , batch_size_(std::max<std::size_t>(batch_size, 1))
+{
+  response_.version(version);
+  response_.result(http::status::ok);
+  response_.set(http::field::server, "Venturi/1.0");
+  response_.set(http::field::content_type, "application/json");
+  response_.set(http::field::cache_control, "no-cache");
+  response_.keep_alive(keep_alive);
+  response_.chunked(true);
+}
+
+void CatalogStreamer::start(Handler handler) {
+  handler_ = std::move(handler);
+
+  response_.body().data = nullptr;
+  response_.body().more = true;
+
+  stream_.expires_after(write_timeout);
+  http::async_write_header(
+    stream_,
+    serializer_,
+    [self = shared_from_this()](beast::error_code ec, std::size_t) {
+      if (ec) {
+        return self->finish(ec);
+      }
+      self->write_batch();
+    }
+  );
+}
+
+void CatalogStreamer::write_batch() {
+  auto batch{ media_service_->list_media_page(after_, batch_size_) };
+  const bool last{ batch.size() < batch_size_ };
+
+  chunk_.clear();
+  if (!opened_) {
+    chunk_ += "{\"media\":[";
+    opened_ = true;
+  }
+
+  for (const auto& media : batch) {
+    if (wrote_entry_) chunk_ += ',';
+    append_media_json(chunk_, media);
+    wrote_entry_ = true;
+  }
+
+  if (last) {
+    chunk_ += "]}";
+  } else {
+    after_ = batch.back().file_path;
+  }
+
+  response_.body().data = chunk_.data();
+  response_.body().size = chunk_.size();
+  response_.body().more = true;
+
+  stream_.expires_after(write_timeout);
+  http::async_write(
+    stream_,
+    serializer_,
+    [self = shared_from_this(), last](beast::error_code ec, std::size_t) {
+      // need_buffer only means the serializer consumed the whole chunk.
+      if (ec == http::error::need_buffer) {
+        ec = {};
+      }
+      if (ec) {
+        return self->finish(ec);
+      }
+
+      if (last) {
+        self->write_last_chunk();
+      } else {
+        self->write_batch();
+      }
+    }
+  );
+}
+
+void CatalogStreamer::write_last_chunk() {
+  response_.body().data = nullptr;
+  response_.body().size = 0;
+  response_.body().more = false;
+
+  stream_.expires_after(write_timeout);
+  http::async_write(
+    stream_,
+    serializer_,
+    [self = shared_from_this()](beast::error_code ec, std::size_t) {
+      self->finish(ec);
+    }
+  );
+}
+
+void CatalogStreamer::finish(beast::error_code ec) {
+  auto handler{ std::move(handler_) };
+  if (handler) {
+    handler(ec);
+  }
+}
+
+} // namespace venturi::adapters
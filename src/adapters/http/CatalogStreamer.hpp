@@ -0,0 +1,53 @@
+#pragma once
+#include "../storage/FileSystemMediaService.hpp"
+
+#include <boost/beast.hpp>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace venturi::adapters {
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+
+// Writes the whole media listing as one chunked JSON document, fetching
+// and serializing `batch_size` titles per chunk. Memory stays bounded by a
+// batch and the first bytes leave before the catalog has been walked.
+class CatalogStreamer : public std::enable_shared_from_this<CatalogStreamer> {
+public:
+  using Handler = std::function<void(beast::error_code)>;
+
+  CatalogStreamer(
+    beast::tcp_stream&                    stream,
+    std::shared_ptr<MediaService>         media_service,
+    unsigned                              version,
+    bool                                  keep_alive,
+    std::size_t                           batch_size
+  );
+
+  // Writes header, batches and the final chunk, then calls `handler`.
+  void start(Handler handler);
+
+private:
+  void write_batch();
+  void write_last_chunk();
+  void finish(beast::error_code ec);
+
+  beast::tcp_stream& stream_;
+  std::shared_ptr<MediaService> media_service_;
+  std::size_t batch_size_;
+
+  http::response<http::buffer_body> response_;
+  http::response_serializer<http::buffer_body> serializer_{ response_ };
+
+  // Path of the last title written; the next batch starts after it.
+  std::filesystem::path after_;
+  std::string chunk_;
+  bool opened_{ false };
+  bool wrote_entry_{ false };
+  Handler handler_;
+};
+
+} // namespace venturi::adapters
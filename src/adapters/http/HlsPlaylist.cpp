@@ -0,0 +1,89 @@
+#include "HlsPlaylist.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <vector>
+
+namespace venturi::adapters {
+
+namespace {
+
+struct Segment {
+  uint32_t duration_ms;
+  uint64_t offset;
+  uint64_t length;
+};
+
+void append_duration(std::string& out, uint32_t ms) {
+  char text[24];
+  std::snprintf(text, sizeof(text), "%u.%03u", ms / 1000, ms % 1000);
+  out += text;
+}
+
+} // namespace
+
+std::optional<std::string> make_hls_playlist(
+  const core::MediaInfo&  media,
+  const SeekIndex&        index,
+  uint32_t                target_segment_ms
+) {
+  const auto& container{ media.container };
+  auto end{ index.end() };
+  if (container.format != core::ContainerInfo::Format::mp4 || !container.fragmented
+      || !end || index.empty()) {
+    return std::nullopt;
+  }
+
+  const uint64_t init_length{ container.index_offset + container.index_size };
+  if (container.index_size == 0 || init_length > index.at(0).offset) {
+    return std::nullopt;
+  }
+
+  // Greedily merge fragments until a segment is long enough; the last one
+  // takes whatever is left.
+  std::vector<Segment> segments;
+  uint32_t longest_ms{ 0 };
+  for (std::size_t first{ 0 }; first < index.size();) {
+    auto start{ index.at(first) };
+    std::size_t next{ first + 1 };
+    while (next < index.size() && index.at(next).time_ms - start.time_ms < target_segment_ms) {
+      ++next;
+    }
+
+    auto stop{ next < index.size() ? index.at(next) : *end };
+    if (stop.offset <= start.offset || stop.time_ms < start.time_ms) {
+      return std::nullopt;
+    }
+
+    segments.push_back({ stop.time_ms - start.time_ms, start.offset, stop.offset - start.offset });
+    longest_ms = std::max(longest_ms, stop.time_ms - start.time_ms);
+    first = next;
+  }
+
+  auto hex{ media.id.hex() };
+  std::string uri{ "/api/media/" };
+  uri.append(hex.data(), hex.size());
+
+  std::string out;
+  out.reserve(256 + segments.size() * (uri.size() + 64));
+  out += "#EXTM3U\n#EXT-X-VERSION:7\n#EXT-X-TARGETDURATION:";
+  out += std::to_string((longest_ms + 999) / 1000);
+  out += "\n#EXT-X-MEDIA-SEQUENCE:0\n#EXT-X-PLAYLIST-TYPE:VOD\n#EXT-X-INDEPENDENT-SEGMENTS\n";
+  out += "#EXT-X-MAP:URI=\"" + uri + "\",BYTERANGE=\"" + std::to_string(init_length) + "@0\"\n";
+
+  char range[64];
+  for (const auto& segment : segments) {
+    out += "#EXTINF:";
+    append_duration(out, segment.duration_ms);
+    std::snprintf(range, sizeof(range), ",\n#EXT-X-BYTERANGE:%" PRIu64 "@%" PRIu64 "\n",
+      segment.length, segment.offset);
+    out += range;
+    out += uri;
+    out += '\n';
+  }
+  out += "#EXT-X-ENDLIST\n";
+  return out;
+}
+
+} // namespace venturi::adapters
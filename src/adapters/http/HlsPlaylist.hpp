@@ -0,0 +1,26 @@
+#pragma once
+#include "../../core/entities/MediaInfo.hpp"
+#include "../storage/SeekIndex.hpp"
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace venturi::adapters {
+
+// Builds an HLS media playlist (RFC 8216, version 7) that plays a
+// fragmented MP4 as is: the ftyp+moov are the EXT-X-MAP and each segment
+// is an EXT-X-BYTERANGE slice of the file, made of whole fragments and
+// cut where a fragment opens on a keyframe. Every URI is the title's own
+// /api/media/{id}, so segments go through the ordinary Range path.
+//
+// Segments run to at least `target_segment_ms` where the fragments allow.
+// Nullopt unless `index` came from the fragments of `media` and the moov
+// precedes them; a progressive MP4 cannot be cut into HLS segments
+// without remuxing.
+std::optional<std::string> make_hls_playlist(
+  const core::MediaInfo&  media,
+  const SeekIndex&        index,
+  uint32_t                target_segment_ms
+);
+
+} // namespace venturi::adapters
@@ -0,0 +1,194 @@
+#include "HttpHeaders.hpp"
+#include <array>
+#include <charconv>
+
+namespace venturi::adapters {
+
+namespace {
+
+std::string_view trim(std::string_view value) {
+  while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+    value.remove_prefix(1);
+  }
+  while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+    value.remove_suffix(1);
+  }
+  return value;
+}
+
+std::string_view strip_weak(std::string_view etag) {
+  if (etag.starts_with("W/")) {
+    etag.remove_prefix(2);
+  }
+  return etag;
+}
+
+constexpr std::array<std::string_view, 7> day_names{
+  "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
+};
+
+constexpr std::array<std::string_view, 12> month_names{
+  "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+};
+
+void append_2digits(std::string& out, unsigned value) {
+  out.push_back(static_cast<char>('0' + value / 10 % 10));
+  out.push_back(static_cast<char>('0' + value % 10));
+}
+
+bool parse_number(std::string_view text, int& value) {
+  auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+  return ec == std::errc{} && ptr == text.data() + text.size();
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (std::size_t i{ 0 }; i < a.size(); ++i) {
+    char x{ a[i] };
+    char y{ b[i] };
+    if (x >= 'A' && x <= 'Z') x = static_cast<char>(x - 'A' + 'a');
+    if (y >= 'A' && y <= 'Z') y = static_cast<char>(y - 'A' + 'a');
+    if (x != y) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Calls `fn` with each trimmed, non-empty element of a comma list until
+// it returns true.
+template <typename Fn>
+bool any_element(std::string_view list, Fn&& fn) {
+  while (!list.empty()) {
+    std::size_t comma{ list.find(',') };
+    std::string_view element{ trim(list.substr(0, comma)) };
+    list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+
+    if (!element.empty() && fn(element)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+bool etag_list_matches(std::string_view list, std::string_view etag) {
+  if (trim(list) == "*") {
+    return true;
+  }
+
+  etag = strip_weak(etag);
+  return any_element(list, [etag](std::string_view candidate) {
+    return strip_weak(candidate) == etag;
+  });
+}
+
+bool etag_strong_equals(std::string_view a, std::string_view b) {
+  a = trim(a);
+  b = trim(b);
+  return !a.starts_with("W/") && !b.starts_with("W/") && !a.empty() && a == b;
+}
+
+std::string format_http_date(std::chrono::system_clock::time_point time) {
+  using namespace std::chrono;
+
+  auto seconds{ floor<std::chrono::seconds>(time) };
+  auto days{ floor<std::chrono::days>(seconds) };
+  year_month_day date{ days };
+  hh_mm_ss clock{ seconds - days };
+  weekday day{ days };
+
+  std::string out;
+  out.reserve(29);
+  out += day_names[day.c_encoding()];
+  out += ", ";
+  append_2digits(out, static_cast<unsigned>(date.day()));
+  out += ' ';
+  out += month_names[static_cast<unsigned>(date.month()) - 1];
+  out += ' ';
+  out += std::to_string(static_cast<int>(date.year()));
+  out += ' ';
+  append_2digits(out, static_cast<unsigned>(clock.hours().count()));
+  out += ':';
+  append_2digits(out, static_cast<unsigned>(clock.minutes().count()));
+  out += ':';
+  append_2digits(out, static_cast<unsigned>(clock.seconds().count()));
+  out += " GMT";
+  return out;
+}
+
+std::optional<std::chrono::system_clock::time_point> parse_http_date(std::string_view value) {
+  using namespace std::chrono;
+
+  // "Sun, 06 Nov 1994 08:49:37 GMT"
+  value = trim(value);
+  if (value.size() != 29 || value[3] != ',' || value[4] != ' ' || value[7] != ' ' ||
+      value[11] != ' ' || value[16] != ' ' || value[19] != ':' || value[22] != ':' ||
+      value.substr(25) != " GMT") {
+    return std::nullopt;
+  }
+
+  int day_of_month{ 0 }, year_number{ 0 }, hour{ 0 }, minute{ 0 }, second{ 0 };
+  if (!parse_number(value.substr(5, 2), day_of_month) ||
+      !parse_number(value.substr(12, 4), year_number) ||
+      !parse_number(value.substr(17, 2), hour) ||
+      !parse_number(value.substr(20, 2), minute) ||
+      !parse_number(value.substr(23, 2), second)) {
+    return std::nullopt;
+  }
+
+  std::string_view month_name{ value.substr(8, 3) };
+  unsigned month_number{ 0 };
+  for (unsigned i{ 0 }; i < month_names.size(); ++i) {
+    if (month_names[i] == month_name) {
+      month_number = i + 1;
+    }
+  }
+
+  year_month_day date{ year{ year_number }, month{ month_number },
+                       std::chrono::day{ static_cast<unsigned>(day_of_month) } };
+  if (!date.ok() || hour > 23 || minute > 59 || second > 60) {
+    return std::nullopt;
+  }
+
+  return sys_days{ date } + hours{ hour } + minutes{ minute } + seconds{ second };
+}
+
+bool accepts_encoding(std::string_view accept_encoding, std::string_view coding) {
+  // An explicit entry for the coding wins over "*".
+  enum class Verdict { unlisted, allowed, refused };
+  Verdict named{ Verdict::unlisted };
+  Verdict wildcard{ Verdict::unlisted };
+
+  any_element(accept_encoding, [&](std::string_view element) {
+    std::size_t semicolon{ element.find(';') };
+    std::string_view name{ trim(element.substr(0, semicolon)) };
+
+    // "q=0", "q=0.0", "q=0.000" refuse the coding; anything else allows it.
+    bool allowed{ true };
+    if (semicolon != std::string_view::npos) {
+      std::string_view params{ trim(element.substr(semicolon + 1)) };
+      if (params.starts_with("q=") || params.starts_with("Q=")) {
+        params.remove_prefix(2);
+        allowed = params.find_first_not_of("0.") != std::string_view::npos;
+      }
+    }
+
+    if (iequals(name, coding)) {
+      named = allowed ? Verdict::allowed : Verdict::refused;
+    } else if (name == "*") {
+      wildcard = allowed ? Verdict::allowed : Verdict::refused;
+    }
+    return false;
+  });
+
+  if (named != Verdict::unlisted) {
+    return named == Verdict::allowed;
+  }
+  return wildcard == Verdict::allowed;
+}
+
+} // namespace venturi::adapters
@@ -0,0 +1,29 @@
+#pragma once
+#include <chrono>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace venturi::adapters {
+
+// True if `etag` appears in an If-None-Match style list (`"a", W/"b"`) or
+// the list is "*". Uses the weak comparison RFC 9110 prescribes for
+// If-None-Match, so W/ prefixes are ignored on both sides.
+bool etag_list_matches(std::string_view list, std::string_view etag);
+
+// Strong comparison (If-Range): both tags must be identical and neither
+// may be weak.
+bool etag_strong_equals(std::string_view a, std::string_view b);
+
+// IMF-fixdate, e.g. "Sun, 06 Nov 1994 08:49:37 GMT", truncated to seconds.
+std::string format_http_date(std::chrono::system_clock::time_point time);
+
+// Parses IMF-fixdate only; the obsolete RFC 850 and asctime forms, like
+// any other malformed date, yield nullopt and the header is ignored.
+std::optional<std::chrono::system_clock::time_point> parse_http_date(std::string_view value);
+
+// True if an Accept-Encoding value allows `coding` (e.g. "gzip"), either by
+// name or through "*", with a non-zero q-value.
+bool accepts_encoding(std::string_view accept_encoding, std::string_view coding);
+
+} // namespace venturi::adapters
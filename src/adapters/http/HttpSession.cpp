@@ -1,29 +1,104 @@
 #include "HttpSession.hpp"
+#include "HttpHeaders.hpp"
+#include "CatalogJson.hpp"
+#include "CatalogStreamer.hpp"
+#include "HlsPlaylist.hpp"
+#include "../storage/FaststartOptimizer.hpp"
 #include "../../../app/Logger.hpp"
 
 #include <boost/beast/version.hpp>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <random>
+#include <charconv>
+#include <cinttypes>
+#include <fcntl.h>
 
 namespace venturi::adapters {
 
+namespace {
+
+enum class Endpoint {
+  list_media,
+  get_media,
+  seek_media,
+  hls_playlist,
+  scan,
+  list_jobs,
+  get_job,
+  cancel_job,
+};
+
+constexpr Router routes{ std::array{
+  Route{ http::verb::get,     "/api/media",                     Endpoint::list_media },
+  Route{ http::verb::get,     "/api/media/{id}",                Endpoint::get_media },
+  Route{ http::verb::get,     "/api/media/{id}/seek",           Endpoint::seek_media },
+  Route{ http::verb::get,     "/api/media/{id}/playlist.m3u8",  Endpoint::hls_playlist },
+  Route{ http::verb::post,    "/api/scan",                      Endpoint::scan },
+  Route{ http::verb::get,     "/api/jobs",                      Endpoint::list_jobs },
+  Route{ http::verb::get,     "/api/jobs/{id}",                 Endpoint::get_job },
+  Route{ http::verb::delete_, "/api/jobs/{id}",                 Endpoint::cancel_job },
+} };
+
+static_assert(routes.match(http::verb::get, "/api/media/ab12?t=3").id == Endpoint::get_media);
+static_assert(routes.match(http::verb::get, "/api/media/ab12/seek?t=3").id == Endpoint::seek_media);
+static_assert(routes.match(http::verb::get, "/api/media/ab12/playlist.m3u8").id == Endpoint::hls_playlist);
+static_assert(routes.match(http::verb::post, "/api/media").status == RouteStatus::method_not_allowed);
+
+void append_job_json(std::string& out, const core::Job& job) {
+  char rate[32];
+  std::snprintf(rate, sizeof(rate), "%.1f", job.files_per_second());
+
+  out += "{\"id\":";
+  append_json_string(out, job.id());
+  out += ",\"kind\":";
+  append_json_string(out, job.kind());
+  out += ",\"state\":";
+  append_json_string(out, core::to_string(job.state()));
+  out += ",\"directories_visited\":" + std::to_string(job.directories());
+  out += ",\"files_found\":" + std::to_string(job.files());
+  out += ",\"files_per_second\":";
+  out += rate;
+  out += ",\"elapsed_ms\":" + std::to_string(job.elapsed().count());
+  if (job.state() == core::JobState::failed) {
+    out += ",\"error\":";
+    append_json_string(out, job.error());
+  }
+  out += '}';
+}
+
+// Clients may keep the listing but must revalidate it, which is a 304.
+constexpr char catalog_cache_control[]{ "no-cache" };
+
+} // namespace
+
 HttpSession::HttpSession(
   tcp::socket                           socket,
-  std::shared_ptr<core::MediaService>   media_service,
-  const Config&                         config
+  std::shared_ptr<MediaService>         media_service,
+  std::shared_ptr<MediaReader>          media_reader,
+  std::shared_ptr<CatalogCache>         catalog_cache,
+  const Config&                         config,
+  IoUringEngine*                        io_engine
 ) 
   : stream_(std::move(socket))
   , media_service_(std::move(media_service))
+  , media_reader_(std::move(media_reader))
+  , catalog_cache_(std::move(catalog_cache))
   , config_(config)
+  , media_cache_control_("public, max-age=" + std::to_string(config.media_cache_max_age))
+  , io_engine_(io_engine)
 {}
 
 void HttpSession::run() {
-  stream_.expires_after(std::chrono::seconds(30));
   this->do_read();
 }
 
 void HttpSession::do_read() {
   request_ = {}; // reset
+
+  // Re-armed per request: an idle keep-alive connection gets 30s.
+  stream_.expires_after(std::chrono::seconds(30));
   
   http::async_read(
     stream_,
@@ -56,141 +131,678 @@ void HttpSession::on_read(
 
 void HttpSession::handle_request() {
   LOG_INFO(request_.method_string(), " ", request_.target());
-  
-  std::string target{ std::string(request_.target()) };
 
-  if (request_.method() == http::verb::get) {
-    if (target == "/api/media") {
-      return this->handle_list_media();
-    }
+  auto target{ request_.target() };
+  auto route{ routes.match(request_.method(), std::string_view(target.data(), target.size())) };
 
-    else if (target.starts_with("/api/media/")) {
-      std::string media_id{ target.substr(11) };
+  switch (route.status) {
+    case RouteStatus::not_found:
+      return this->send_error(http::status::not_found, "Endpoint not found.");
+    case RouteStatus::method_not_allowed:
+      return this->send_error(http::status::method_not_allowed, "Method not allowed.");
+    case RouteStatus::matched:
+      break;
+  }
 
-      // Removes query parameters
-      if (std::size_t pos{ media_id.find('?') }; pos != std::string::npos) {
-        media_id = media_id.substr(0, pos);
-      }
+  switch (route.id) {
+    case Endpoint::list_media:
+      return this->handle_list_media(route.params.query);
+    case Endpoint::get_media:
+      return this->handle_get_media(route.params[0]);
+    case Endpoint::seek_media:
+      return this->handle_seek_media(route.params[0], route.params.query);
+    case Endpoint::hls_playlist:
+      return this->handle_hls_playlist(route.params[0]);
+    case Endpoint::scan:
+      return this->handle_scan();
+    case Endpoint::list_jobs:
+      return this->handle_list_jobs();
+    case Endpoint::get_job:
+      return this->handle_get_job(route.params[0]);
+    case Endpoint::cancel_job:
+      return this->handle_cancel_job(route.params[0]);
+  }
+}
 
-      return this->handle_get_media(media_id);
-    }
+core::MediaHandle HttpSession::find_served_media(std::string_view media_id) const {
+  auto id{ core::MediaId::parse(media_id) };
+  auto media{ id ? media_service_->get_media(*id) : nullptr };
+  if (!media || media->optimized_path.empty()) {
+    return media;
+  }
 
-    else if (target == "/api/scan") {
-      return this->handle_scan();
-    }
+  // The copy has its own validators and cache entries. Checking it costs a
+  // stat(2), which also catches a copy deleted behind our back.
+  if (auto copy = faststart_copy(*media)) {
+    return std::make_shared<const core::MediaInfo>(std::move(*copy));
   }
-  
-  this->send_error(http::status::not_found, "Endpoint not found.");
+  return media;
 }
 
-void HttpSession::handle_get_media(const std::string& media_id) {
-  auto media{ media_service_->get_media(media_id) };
+void HttpSession::handle_get_media(std::string_view media_id) {
+  auto media{ this->find_served_media(media_id) };
   if (!media) {
     return this->send_error(http::status::not_found, "Media not found.");
   }
-  
-  beast::error_code ec;
-  http::file_body::value_type body;
-  body.open(media->file_path.string().c_str(), beast::file_mode::scan, ec);
 
-  if (ec) {
-    LOG_ERROR("Failed to open file: ", media->file_path.string());
-    return this->send_error(http::status::internal_server_error, "File access error");
+  const auto etag{ media->etag() };
+  const beast::string_view etag_value{ etag.text.data(), etag.length };
+
+  if (!etag.empty() && this->is_not_modified(*media)) {
+    return this->send_not_modified(etag_value, media_cache_control_);
   }
+  
+  // A cached head/tail already knows the size, so header probes can be
+  // answered without touching the disk at all.
+  auto cached{ media_reader_->header_cache().find(*media) };
+
+  std::error_code ec;
+  FileHandle file;
+  uint64_t file_size{ 0 };
+
+  // Validators are only sent while the file still matches the scan.
+  bool validators_current{ false };
+
+  if (cached) {
+    file_size = cached->file_size;
+    validators_current = cached->file_size == media->file_size;
+  } else {
+    file = FileHandle::open_read(media->file_path, ec);
+    if (ec) {
+      LOG_ERROR("Failed to open file: ", media->file_path);
+      return this->send_error(http::status::internal_server_error, "File access error");
+    }
 
-  uint64_t file_size = body.size();
+    auto status{ file.status(ec) };
+    if (ec) {
+      LOG_ERROR("Failed to stat file: ", media->file_path);
+      return this->send_error(http::status::internal_server_error, "File access error");
+    }
 
-  auto response = std::make_shared<http::response<http::file_body>>(
-    std::piecewise_construct,
-    std::make_tuple(std::move(body)),
-    std::make_tuple(http::status::ok, request_.version())
+    file_size = status.size;
+    validators_current = status.size == media->file_size
+      && status.inode == media->inode
+      && status.modified_at == media->modified_at;
+
+    media_reader_->prefetch_headers(*media);
+  }
+
+  auto response = std::make_shared<http::response<http::empty_body>>(
+    http::status::ok, request_.version()
   );
   
   response->set(http::field::server, "Venturi/1.0");
-  response->set(http::field::content_type, media->mime_type);
+  const auto mime_type{ core::to_string(media->mime_type) };
+  response->set(http::field::content_type, beast::string_view(mime_type.data(), mime_type.size()));
   response->set(http::field::accept_ranges, "bytes");
   response->keep_alive(request_.keep_alive());
 
+  validators_current &= !etag.empty();
+  if (validators_current) {
+    response->set(http::field::etag, etag_value);
+    response->set(http::field::last_modified, format_http_date(media->modified_at));
+    response->set(http::field::cache_control, media_cache_control_);
+  }
+
+  std::vector<BodySegment> segments;
+  core::ByteRangeSet ranges;
+
+  // A failed If-Range means the client's partial copy is stale: send the
+  // whole file instead of the requested pieces.
   auto range_header = request_.find(http::field::range);
-  if (range_header != request_.end()) {
-    auto range = media_service_->parse_range_header(
-      std::string(range_header->value()), file_size
+  const bool range_allowed{ request_[http::field::if_range].empty()
+    || (validators_current && this->if_range_matches(*media)) };
+
+  if (range_header != request_.end() && range_allowed) {
+    const auto value{ range_header->value() };
+    auto status = media_service_->parse_range_header(
+      std::string_view(value.data(), value.size()), file_size, ranges
     );
 
-    if (range) {
-      response->result(http::status::partial_content);
-      
-      response->body().seek(range->start, ec); 
-      if(ec) return send_error(http::status::internal_server_error, "Seek failed");
+    if (status == core::RangeParseStatus::unsatisfiable) {
+      response->result(http::status::range_not_satisfiable);
+      response->set(http::field::content_range, "bytes */" + std::to_string(file_size));
+      response->content_length(0);
+      return this->send_file_range(std::move(response), {}, BodySource{});
+    }
+  }
+
+  if (ranges.empty()) {
+    // No Range, or one we must ignore: send the whole file.
+    this->append_range_segments(segments, cached, 0, file_size);
+  } else {
+    response->result(http::status::partial_content);
 
-      // (TODO): [BUG] Beast's file_body seems to always read to EOF.
-      //         May need to implement platform specific disk-to-socket support.
-      response->content_length(range->length());
+    if (ranges.size() == 1) {
+      const auto& range{ ranges.front() };
 
       std::ostringstream range_str;
-      range_str << "bytes " << range->start << "-" << range->end << "/" << range->total_size;
+      range_str << "bytes " << range.start << "-" << range.end << "/" << range.total_size;
       response->set(http::field::content_range, range_str.str());
+
+      this->append_range_segments(segments, cached, range.start, range.length());
     } else {
-      return send_error(http::status::range_not_satisfiable, "Invalid Range");
+      segments = this->make_multipart_body(*response, ranges, mime_type, cached);
     }
-  } else {
-    // Full file
-    response->content_length(file_size);
   }
 
+  uint64_t content_length{ 0 };
+  bool needs_file{ false };
+  for (const auto& segment : segments) {
+    content_length += segment.size();
+    needs_file |= segment.kind == BodySegment::Kind::file && segment.length > 0;
+  }
+  response->content_length(content_length);
+
+  BodySource source;
+  source.stream_token = media_reader_->track_stream(media->id);
+
+  // A play starts with the connection's first request for the title.
+  const bool new_play{ current_media_id_ != media->id };
+  current_media_id_ = media->id;
+
+  // Several sessions on one title coalesce their reads in the block cache;
+  // a large, cold file bypasses the page cache; anything else uses it.
+  auto read_path{ BodySegment::ReadPath::kernel };
+  if (needs_file) {
+    if (media_reader_->prefer_block_cache(media->id)) {
+      read_path = BodySegment::ReadPath::block_cache;
+      source.cache_source = BlockCache::Source::from(*media);
+    } else if (media_reader_->prefer_direct_io(media->id, file_size)) {
+      // Not every filesystem supports O_DIRECT; fall back quietly.
+      std::error_code direct_ec;
+      source.direct_file = FileHandle::open_read(media->file_path, direct_ec, O_DIRECT);
+      if (!direct_ec) {
+        read_path = BodySegment::ReadPath::direct;
+      }
+    }
+  }
+
+  if (new_play) {
+    media_reader_->record_play(media->id);
+  }
+
+  for (auto& segment : segments) {
+    if (segment.kind == BodySegment::Kind::file) {
+      segment.read_path = read_path;
+    }
+  }
+
+  if (read_path == BodySegment::ReadPath::kernel && needs_file) {
+    if (config_.readahead_enabled) {
+      if (!prefetcher_ || prefetcher_->media_id() != media->id) {
+        prefetcher_ = std::make_shared<StreamPrefetcher>(*media_reader_, config_, *media, file_size);
+      }
+
+      for (const auto& segment : segments) {
+        if (segment.kind == BodySegment::Kind::file) {
+          prefetcher_->on_request(segment.offset);
+          break;
+        }
+      }
+    }
+
+    if (!file.is_open()) {
+      file = FileHandle::open_read(media->file_path, ec);
+      if (ec) {
+        LOG_ERROR("Failed to open file: ", media->file_path);
+        return this->send_error(http::status::internal_server_error, "File access error");
+      }
+    }
+  }
+
+  source.file = std::move(file);
+  source.readahead = read_path == BodySegment::ReadPath::kernel;
+
+  this->send_file_range(std::move(response), std::move(segments), std::move(source));
+}
+
+void HttpSession::handle_seek_media(std::string_view media_id, std::string_view query) {
+  // Offsets must point into the file that GET serves.
+  auto media{ this->find_served_media(media_id) };
+  if (!media) {
+    return this->send_error(http::status::not_found, "Media not found.");
+  }
+
+  // Seconds, fractions allowed.
+  auto t_param{ query_param(query, "t") };
+  double seconds{ -1.0 };
+  if (t_param) {
+    const char* end{ t_param->data() + t_param->size() };
+    auto [ptr, ec] = std::from_chars(t_param->data(), end, seconds);
+    if (ec != std::errc{} || ptr != end) {
+      seconds = -1.0;
+    }
+  }
+  if (!(seconds >= 0.0 && seconds < 4'000'000.0)) {
+    return this->send_error(http::status::bad_request, "Invalid t.");
+  }
+  const auto time_ms{ static_cast<uint32_t>(seconds * 1000.0) };
+
+  if (media->container.index_size == 0) {
+    return this->send_seek_result(*media, nullptr, time_ms);
+  }
+
+  this->with_seek_index(media, [this, media, time_ms](const SeekIndex* index) {
+    this->send_seek_result(*media, index, time_ms);
+  });
+}
+
+void HttpSession::with_seek_index(
+  core::MediaHandle                          media,
+  std::function<void(const SeekIndex*)>      then
+) {
+  if (auto index = media_reader_->seek_index_cache().find(*media)) {
+    return then(index.get());
+  }
+
+  // Decoding sample tables can take a few milliseconds of reads and CPU;
+  // build on the disk pool and answer back on this connection's executor.
+  asio::post(media_reader_->disk_pool(), [self = shared_from_this(), media, then = std::move(then)]() mutable {
+    auto index = self->media_reader_->seek_index_cache().load(*media);
+    asio::post(self->stream_.get_executor(), [self, index = std::move(index), then = std::move(then)] {
+      then(index.get());
+    });
+  });
+}
+
+void HttpSession::handle_hls_playlist(std::string_view media_id) {
+  auto media{ this->find_served_media(media_id) };
+  if (!media) {
+    return this->send_error(http::status::not_found, "Media not found.");
+  }
+
+  const auto& container{ media->container };
+  if (container.format != core::ContainerInfo::Format::mp4 || !container.fragmented) {
+    return this->send_error(http::status::unprocessable_entity,
+      "HLS is only offered for fragmented MP4; stream this media directly.");
+  }
+
+  // The playlist is derived from the file alone, so it shares its validators.
+  const auto etag{ media->etag() };
+  if (!etag.empty() && this->is_not_modified(*media)) {
+    return this->send_not_modified(beast::string_view{ etag.text.data(), etag.length }, media_cache_control_);
+  }
+
+  this->with_seek_index(media, [this, media](const SeekIndex* index) {
+    this->send_hls_playlist(*media, index);
+  });
+}
+
+void HttpSession::send_hls_playlist(const core::MediaInfo& media, const SeekIndex* index) {
+  auto playlist{ index ? make_hls_playlist(media, *index, config_.hls_segment_ms) : std::nullopt };
+  if (!playlist) {
+    return this->send_error(http::status::unprocessable_entity, "No keyframe fragments to cut segments from.");
+  }
+
+  auto response = std::make_shared<http::response<http::string_body>>(
+    http::status::ok, request_.version()
+  );
+
+  response->set(http::field::server, "Venturi/1.0");
+  response->set(http::field::content_type, "application/vnd.apple.mpegurl");
+  const auto etag{ media.etag() };
+  if (!etag.empty()) {
+    response->set(http::field::etag, beast::string_view{ etag.text.data(), etag.length });
+    response->set(http::field::cache_control, media_cache_control_);
+  }
+  response->keep_alive(request_.keep_alive());
+  response->body() = std::move(*playlist);
+  response->prepare_payload();
 
   http::async_write(
     stream_,
     *response,
-    [self = shared_from_this(), response](beast::error_code ec, std::size_t bytes_transferred) {
+    [self = shared_from_this(), response](beast::error_code ec, std::size_t) {
+      if (ec) return;
+      if (self->request_.keep_alive()) self->do_read();
+      else self->do_close();
+    }
+  );
+}
+
+void HttpSession::send_seek_result(
+  const core::MediaInfo&  media,
+  const SeekIndex*        index,
+  uint32_t                time_ms
+) {
+  std::optional<SeekIndex::Point> point;
+  bool exact{ false };
+
+  if (index) {
+    point = index->find(time_ms);
+    exact = point.has_value();
+  }
+
+  // Without an index, fall back to what a client would have guessed: the
+  // average bitrate from the start of the media data.
+  const auto& container{ media.container };
+  if (!point && container.bitrate > 0 && container.media_offset > 0 && container.media_offset < media.file_size) {
+    uint64_t offset{ container.media_offset + uint64_t{ time_ms } * container.bitrate / 8000 };
+    point = SeekIndex::Point{ time_ms, std::min(offset, media.file_size - 1) };
+  }
+
+  if (!point) {
+    return this->send_error(http::status::unprocessable_entity, "No seek information for this media.");
+  }
+
+  char json[160];
+  auto hex{ media.id.hex() };
+  std::snprintf(json, sizeof(json),
+    "{\"id\":\"%.*s\",\"time\":%u.%03u,\"offset\":%" PRIu64 ",\"exact\":%s}",
+    static_cast<int>(hex.size()), hex.data(),
+    point->time_ms / 1000, point->time_ms % 1000,
+    point->offset, exact ? "true" : "false");
+  this->send_json(json);
+}
+
+bool HttpSession::is_not_modified(const core::MediaInfo& media) const {
+  // If-None-Match takes precedence; If-Modified-Since is then ignored.
+  auto if_none_match{ request_[http::field::if_none_match] };
+  if (!if_none_match.empty()) {
+    return etag_list_matches(std::string_view(if_none_match.data(), if_none_match.size()), media.etag().view());
+  }
+
+  auto if_modified_since{ request_[http::field::if_modified_since] };
+  if (!if_modified_since.empty()) {
+    auto since{ parse_http_date(std::string_view(if_modified_since.data(), if_modified_since.size())) };
+    return since && std::chrono::floor<std::chrono::seconds>(media.modified_at) <= *since;
+  }
+
+  return false;
+}
+
+bool HttpSession::if_range_matches(const core::MediaInfo& media) const {
+  auto if_range{ request_[http::field::if_range] };
+  std::string_view value{ if_range.data(), if_range.size() };
+
+  // An entity-tag must match strongly; a date must equal Last-Modified.
+  if (value.starts_with('"') || value.starts_with("W/")) {
+    return etag_strong_equals(value, media.etag().view());
+  }
+
+  auto date{ parse_http_date(value) };
+  return date && std::chrono::floor<std::chrono::seconds>(media.modified_at) == *date;
+}
+
+void HttpSession::append_range_segments(
+  std::vector<BodySegment>&                         segments,
+  const std::shared_ptr<const HeaderCache::Entry>&  cached,
+  uint64_t                                          start,
+  uint64_t                                          length
+) {
+  const uint64_t end{ start + length };
+
+  if (!cached) {
+    segments.push_back(BodySegment::file(start, length));
+    return;
+  }
+
+  const uint64_t head_end{ cached->head.size() };
+  const uint64_t tail_start{ cached->tail_offset() };
+
+  if (start < head_end) {
+    uint64_t n{ std::min(end, head_end) - start };
+    segments.push_back(BodySegment::view(
+      asio::buffer(cached->head.data() + start, n), cached
+    ));
+    start += n;
+  }
+
+  if (start < end && start < tail_start) {
+    uint64_t n{ std::min(end, tail_start) - start };
+    segments.push_back(BodySegment::file(start, n));
+    start += n;
+  }
+
+  if (start < end) {
+    segments.push_back(BodySegment::view(
+      asio::buffer(cached->tail.data() + (start - tail_start), end - start), cached
+    ));
+  }
+}
+
+std::vector<BodySegment> HttpSession::make_multipart_body(
+  http::response<http::empty_body>&                 response,
+  const core::ByteRangeSet&                         ranges,
+  std::string_view                                  mime_type,
+  const std::shared_ptr<const HeaderCache::Entry>&  cached
+) {
+  static constexpr char hex[]{ "0123456789abcdef" };
+  thread_local std::mt19937_64 rng{ std::random_device{}() };
+
+  std::string boundary{ "venturi-" };
+  for (uint64_t bits{ rng() }, i{ 0 }; i < 16; ++i, bits >>= 4) {
+    boundary += hex[bits & 0xF];
+  }
+
+  response.set(
+    http::field::content_type,
+    "multipart/byteranges; boundary=" + boundary
+  );
+
+  // Part headers are tiny literals; payloads are file regions or cached bytes.
+  std::vector<BodySegment> segments;
+  segments.reserve(ranges.size() * 2 + 1);
+
+  for (const auto& range : ranges) {
+    std::ostringstream part;
+    part << "\r\n--" << boundary << "\r\n"
+         << "Content-Type: " << mime_type << "\r\n"
+         << "Content-Range: bytes " << range.start << "-" << range.end
+         << "/" << range.total_size << "\r\n\r\n";
+
+    segments.push_back(BodySegment::text(part.str()));
+    this->append_range_segments(segments, cached, range.start, range.length());
+  }
+
+  segments.push_back(BodySegment::text("\r\n--" + boundary + "--\r\n"));
+  return segments;
+}
+
+void HttpSession::send_file_range(
+  std::shared_ptr<http::response<http::empty_body>>  response,
+  std::vector<BodySegment>                            segments,
+  BodySource                                          source
+) {
+  auto serializer = std::make_shared<http::response_serializer<http::empty_body>>(*response);
+  auto streamer = std::make_shared<RangeStreamer>(
+    stream_.socket(), std::move(source.file), std::move(segments), io_engine_
+  );
+  if (source.cache_source) {
+    streamer->use_block_cache(media_reader_->block_cache(), std::move(*source.cache_source));
+  }
+  if (source.direct_file.is_open()) {
+    streamer->use_direct_io(std::move(source.direct_file), *media_reader_);
+  }
+  streamer->set_idle_timeout(std::chrono::seconds(config_.send_idle_timeout_seconds));
+  if (prefetcher_ && source.readahead) {
+    streamer->on_progress([prefetcher = prefetcher_](uint64_t offset) {
+      prefetcher->on_progress(offset);
+    });
+  }
+
+  // Header goes through Beast, the body bypasses it entirely.
+  http::async_write_header(
+    stream_,
+    *serializer,
+    [self = shared_from_this(), response, serializer, streamer, stream_token = std::move(source.stream_token)](
+      beast::error_code ec,
+      std::size_t
+    ) {
       if (ec) {
-        if(ec != asio::error::connection_reset)
+        if (ec != asio::error::connection_reset)
           LOG_ERROR("Stream error: ", ec.message());
-        return; 
-      }
-      
-      if (self->request_.keep_alive()) {
-        self->do_read();
-      } else {
-        self->do_close();
+        return;
       }
+
+      // The body may take far longer than a request timeout to drain; the
+      // streamer enforces its own idle timeout instead.
+      self->stream_.expires_never();
+
+      streamer->start([self, stream_token](beast::error_code ec, uint64_t) {
+        if (ec == asio::error::timed_out) {
+          LOG_WARN("Client stopped reading, dropping stream");
+          return;
+        }
+        if (ec) {
+          if (ec != asio::error::connection_reset && ec != asio::error::broken_pipe)
+            LOG_ERROR("Stream error: ", ec.message());
+          return;
+        }
+
+        if (self->request_.keep_alive()) {
+          self->do_read();
+        } else {
+          self->do_close();
+        }
+      });
     }
   );
 }
 
-void HttpSession::handle_list_media() {
-  auto media_list = media_service_->list_all_media();
-  
-  // (TODO): Replace with a proper JSON library
-  std::ostringstream json;
-  json << "{\"media\":[";
-  
-  for (size_t i = 0; i < media_list.size(); ++i) {
-    const auto& m = media_list[i];
-    if (i > 0) json << ",";
-    
-    json << "{"
-          << "\"id\":\"" << m.id << "\","
-          << "\"path\":\"" << m.file_path.string() << "\","
-          << "\"mime\":" << m.mime_type << ","
-          << "}";
+void HttpSession::handle_list_media(std::string_view query) {
+  if (query_param(query, "stream") == "1") {
+    return this->stream_media_list();
   }
-  
-  json << "]}";
-  send_json(json.str());
+
+  auto limit_param{ query_param(query, "limit") };
+  auto after_param{ query_param(query, "after") };
+
+  if (limit_param || after_param) {
+    std::size_t limit{ config_.list_page_max };
+    if (limit_param) {
+      auto [ptr, ec] = std::from_chars(limit_param->data(), limit_param->data() + limit_param->size(), limit);
+      if (ec != std::errc{} || ptr != limit_param->data() + limit_param->size() || limit == 0) {
+        return this->send_error(http::status::bad_request, "Invalid limit.");
+      }
+      limit = std::min<std::size_t>(limit, config_.list_page_max);
+    }
+
+    std::filesystem::path after;
+    if (after_param && !after_param->empty()) {
+      auto cursor{ decode_cursor(*after_param) };
+      if (!cursor) {
+        return this->send_error(http::status::bad_request, "Invalid cursor.");
+      }
+      after = std::move(*cursor);
+    }
+
+    return this->send_media_page(after, limit);
+  }
+
+  auto catalog{ catalog_cache_->current() };
+
+  auto accept_encoding{ request_[http::field::accept_encoding] };
+  bool gzip{ !catalog->gzip.empty() &&
+    accepts_encoding(std::string_view(accept_encoding.data(), accept_encoding.size()), "gzip") };
+  const std::string& etag{ gzip ? catalog->gzip_etag : catalog->etag };
+
+  // Answered from the cached tag alone; the repository is not consulted.
+  auto if_none_match{ request_[http::field::if_none_match] };
+  if (!if_none_match.empty() &&
+      etag_list_matches(std::string_view(if_none_match.data(), if_none_match.size()), etag)) {
+    return this->send_not_modified(etag, catalog_cache_control, "Accept-Encoding");
+  }
+
+  this->send_catalog(std::move(catalog), gzip);
+}
+
+void HttpSession::send_media_page(
+  const std::filesystem::path&  after,
+  std::size_t                   limit
+) {
+  auto page{ media_service_->list_media_page(after, limit) };
+
+  std::string json;
+  json.reserve(64 + page.size() * 128);
+  json += "{\"media\":[";
+  for (std::size_t i{ 0 }; i < page.size(); ++i) {
+    if (i > 0) json += ',';
+    append_media_json(json, page[i]);
+  }
+  json += "],\"next\":";
+
+  // A full page may have more after it; a short one is the end.
+  if (page.size() == limit) {
+    append_json_string(json, encode_cursor(page.back().file_path));
+  } else {
+    json += "null";
+  }
+  json += '}';
+
+  this->send_json(json);
+}
+
+void HttpSession::stream_media_list() {
+  auto streamer = std::make_shared<CatalogStreamer>(
+    stream_, media_service_, request_.version(), request_.keep_alive(), config_.list_stream_batch
+  );
+
+  streamer->start([self = shared_from_this()](beast::error_code ec) {
+    if (ec) {
+      if (ec != asio::error::connection_reset && ec != asio::error::broken_pipe)
+        LOG_ERROR("Listing stream error: ", ec.message());
+      return;
+    }
+
+    if (self->request_.keep_alive()) self->do_read();
+    else self->do_close();
+  });
 }
 
 void HttpSession::handle_scan() {
-  size_t count = media_service_->scan_media_directory(config_.media_root);
+  // The walk runs on the job workers; this thread only queues it.
+  auto job{ media_service_->start_scan(config_.media_root) };
+
+  std::string json;
+  append_job_json(json, *job);
+  this->send_json(json, http::status::accepted);
+}
 
-  std::ostringstream json;
-  json << "{\"scanned\":" << count << "}";
-  send_json(json.str());
+void HttpSession::handle_list_jobs() {
+  std::string json{ "{\"jobs\":[" };
+  bool first{ true };
+  for (const auto& job : media_service_->list_jobs()) {
+    if (!first) json += ',';
+    append_job_json(json, *job);
+    first = false;
+  }
+  json += "]}";
+  this->send_json(json);
 }
 
-void HttpSession::send_json(const std::string& json) {
+void HttpSession::handle_get_job(std::string_view job_id) {
+  auto job{ media_service_->find_job(std::string(job_id)) };
+  if (!job) {
+    return this->send_error(http::status::not_found, "Job not found.");
+  }
+
+  std::string json;
+  append_job_json(json, *job);
+  this->send_json(json);
+}
+
+void HttpSession::handle_cancel_job(std::string_view job_id) {
+  std::string id{ job_id };
+  if (!media_service_->cancel_job(id)) {
+    return this->send_error(http::status::not_found, "Job not found.");
+  }
+
+  // A running job stops at its next check, so report where it is now.
+  auto job{ media_service_->find_job(id) };
+  std::string json;
+  if (job) {
+    append_job_json(json, *job);
+  } else {
+    json = "{}";
+  }
+  this->send_json(json, http::status::accepted);
+}
+
+void HttpSession::send_json(const std::string& json, http::status status) {
   auto response = std::make_shared<http::response<http::string_body>>(
-    http::status::ok, request_.version()
+    status, request_.version()
   );
 
   response->set(http::field::server, "Venturi/1.0");
@@ -210,6 +822,68 @@ void HttpSession::send_json(const std::string& json) {
   );
 }
 
+void HttpSession::send_catalog(
+  std::shared_ptr<const CatalogCache::Body> body,
+  bool gzip
+) {
+  const std::string& payload{ gzip ? body->gzip : body->json };
+
+  auto response = std::make_shared<http::response<http::span_body<const char>>>(
+    http::status::ok, request_.version()
+  );
+
+  response->set(http::field::server, "Venturi/1.0");
+  response->set(http::field::content_type, "application/json");
+  response->set(http::field::etag, gzip ? body->gzip_etag : body->etag);
+  response->set(http::field::cache_control, catalog_cache_control);
+  response->set(http::field::vary, "Accept-Encoding");
+  if (gzip) {
+    response->set(http::field::content_encoding, "gzip");
+  }
+  response->keep_alive(request_.keep_alive());
+  response->body() = { payload.data(), payload.size() };
+  response->prepare_payload();
+
+  // `body` rides along in the handler to keep the shared buffer alive.
+  http::async_write(
+    stream_,
+    *response,
+    [self = shared_from_this(), response, body](beast::error_code ec, std::size_t) {
+      if (ec) return;
+      if (self->request_.keep_alive()) self->do_read();
+      else self->do_close();
+    }
+  );
+}
+
+void HttpSession::send_not_modified(
+  beast::string_view  etag,
+  beast::string_view  cache_control,
+  beast::string_view  vary
+) {
+  auto response = std::make_shared<http::response<http::empty_body>>(
+    http::status::not_modified, request_.version()
+  );
+
+  response->set(http::field::server, "Venturi/1.0");
+  response->set(http::field::etag, etag);
+  response->set(http::field::cache_control, cache_control);
+  if (!vary.empty()) {
+    response->set(http::field::vary, vary);
+  }
+  response->keep_alive(request_.keep_alive());
+
+  http::async_write(
+    stream_,
+    *response,
+    [self = shared_from_this(), response](beast::error_code ec, std::size_t) {
+      if (ec) return;
+      if (self->request_.keep_alive()) self->do_read();
+      else self->do_close();
+    }
+  );
+}
+
 void HttpSession::send_error(
   http::status status,
   const std::string& message
@@ -1,9 +1,18 @@
 #pragma once
-#include "../../core/services/MediaService.hpp"
+#include "../storage/FileSystemMediaService.hpp"
 #include "../../../app/Config.hpp"
+#include "../storage/FileHandle.hpp"
+#include "../storage/MediaReader.hpp"
+#include "../storage/StreamPrefetcher.hpp"
+#include "RangeStreamer.hpp"
+#include "IoUringEngine.hpp"
+#include "Router.hpp"
+#include "CatalogCache.hpp"
 #include <boost/beast.hpp>
 #include <boost/asio.hpp>
+#include <functional>
 #include <memory>
+#include <optional>
 
 namespace venturi::adapters {
 
@@ -16,8 +25,11 @@ class HttpSession : public std::enable_shared_from_this<HttpSession> {
 public:
   HttpSession(
     tcp::socket                           socket,
-    std::shared_ptr<core::MediaService>   media_service,
-    const Config&                         config
+    std::shared_ptr<MediaService>         media_service,
+    std::shared_ptr<MediaReader>          media_reader,
+    std::shared_ptr<CatalogCache>         catalog_cache,
+    const Config&                         config,
+    IoUringEngine*                        io_engine = nullptr
   );
   
   void run();
@@ -32,12 +44,96 @@ private:
   void handle_request();
 
 
-  void handle_get_media(const std::string& media_id);
-  void handle_list_media();
+  void handle_get_media(std::string_view media_id);
+
+  // The entry for `media_id` as served: its faststart copy when it has a
+  // usable one, else the file itself. Null if there is no such entry.
+  core::MediaHandle find_served_media(std::string_view media_id) const;
+
+  // GET /api/media/{id}/seek?t=<seconds>: byte offset of the keyframe at
+  // or before t, from the title's seek index, built on first use.
+  void handle_seek_media(std::string_view media_id, std::string_view query);
+  void send_seek_result(
+    const core::MediaInfo&  media,
+    const SeekIndex*        index,
+    uint32_t                time_ms
+  );
+
+  // Calls `then` with the seek index of `media` (null if it cannot be
+  // read): at once when cached, else on this connection's executor once
+  // the disk pool has built it.
+  void with_seek_index(
+    core::MediaHandle                          media,
+    std::function<void(const SeekIndex*)>      then
+  );
+
+  // GET /api/media/{id}/playlist.m3u8: an HLS playlist of byte ranges of
+  // the file, for fragmented MP4s. See make_hls_playlist().
+  void handle_hls_playlist(std::string_view media_id);
+  void send_hls_playlist(const core::MediaInfo& media, const SeekIndex* index);
+
+  // Conditional GET (RFC 9110 section 13) against the validators captured
+  // at scan time, so neither check needs the file.
+  bool is_not_modified(const core::MediaInfo& media) const;
+  bool if_range_matches(const core::MediaInfo& media) const;
+  // Whole cached listing by default; `limit`/`after` select a page and
+  // `stream=1` writes the listing in chunked batches.
+  void handle_list_media(std::string_view query);
+  void send_media_page(const std::filesystem::path& after, std::size_t limit);
+  void stream_media_list();
   void handle_scan();
+  void handle_list_jobs();
+  void handle_get_job(std::string_view job_id);
+  void handle_cancel_job(std::string_view job_id);
   
+  // Appends [start, start + length) as body segments, taking whatever
+  // overlaps the cached head/tail from memory and the rest from the file.
+  void append_range_segments(
+    std::vector<BodySegment>&                         segments,
+    const std::shared_ptr<const HeaderCache::Entry>&  cached,
+    uint64_t                                          start,
+    uint64_t                                          length
+  );
+
+  // Builds a multipart/byteranges body and sets the matching Content-Type.
+  std::vector<BodySegment> make_multipart_body(
+    http::response<http::empty_body>&                 response,
+    const core::ByteRangeSet&                         ranges,
+    std::string_view                                  mime_type,
+    const std::shared_ptr<const HeaderCache::Entry>&  cached
+  );
+
+  // Where the file regions of a media response are read from.
+  struct BodySource {
+    FileHandle file;                                  // ReadPath::kernel
+    std::optional<BlockCache::Source> cache_source;   // ReadPath::block_cache
+    FileHandle direct_file;                           // ReadPath::direct
+    bool readahead{ false };
+
+    // Keeps the title counted as actively streamed until the body is sent.
+    std::shared_ptr<const void> stream_token;
+  };
+
+  // Writes `response`'s header, then each segment of the body in order.
+  void send_file_range(
+    std::shared_ptr<http::response<http::empty_body>>  response,
+    std::vector<BodySegment>                            segments,
+    BodySource                                          source
+  );
+
   void send_error(http::status status, const std::string& message);
-  void send_json(const std::string& json);
+  void send_json(const std::string& json, http::status status = http::status::ok);
+
+  // Writes the cached catalog without copying it; `gzip` picks the
+  // compressed variant.
+  void send_catalog(std::shared_ptr<const CatalogCache::Body> body, bool gzip);
+
+  // 304 for a cached representation the client already has.
+  void send_not_modified(
+    beast::string_view  etag,
+    beast::string_view  cache_control,
+    beast::string_view  vary = {}
+  );
   
   // Gracefully close the connection.
   void do_close();
@@ -46,8 +142,16 @@ private:
   beast::flat_buffer buffer_;
   http::request<http::string_body> request_;
   
-  std::shared_ptr<core::MediaService> media_service_;
+  std::shared_ptr<MediaService> media_service_;
+  std::shared_ptr<MediaReader> media_reader_;
+  std::shared_ptr<CatalogCache> catalog_cache_;
+
+  // Readahead state for the title this connection last streamed.
+  std::shared_ptr<StreamPrefetcher> prefetcher_;
+  std::optional<core::MediaId> current_media_id_;
   const Config& config_;
+  std::string media_cache_control_;
+  IoUringEngine* io_engine_;
 };
 
 } // namespace venturi::adapters
\ No newline at end of file
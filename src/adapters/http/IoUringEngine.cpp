@@ -0,0 +1,479 @@
+#include "IoUringEngine.hpp"
+#include "../../../app/Logger.hpp"
+
+#include <stdexcept>
+
+#if defined(VENTURI_HAS_IO_URING)
+#include <liburing.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <vector>
+#endif
+
+namespace venturi::adapters {
+
+#if defined(VENTURI_HAS_IO_URING)
+
+namespace {
+
+constexpr unsigned pipe_capacity{ 1024 * 1024 };
+
+beast::error_code from_result(int res) {
+  return beast::error_code(-res, beast::system_category());
+}
+
+} // namespace
+
+struct IoUringEngine::Impl {
+  struct Transfer;
+
+  // user_data of every SQE: which link of a transfer's chain completed.
+  struct Op {
+    enum class Kind { fill, drain, poll };
+
+    Transfer* transfer;
+    Kind kind;
+  };
+
+  struct Transfer {
+    int socket_fd{ -1 };
+    int file_fd{ -1 };
+    int slot{ -1 };
+
+    uint64_t offset{ 0 };
+    uint64_t remaining{ 0 };
+    uint64_t sent{ 0 };
+
+    bool use_splice{ true };
+    int pipe_fds[2]{ -1, -1 };
+    int buffer{ -1 };
+
+    // Bytes moved off disk into the pipe/buffer, and how many of those
+    // have reached the socket.
+    uint32_t staged{ 0 };
+    uint32_t staged_sent{ 0 };
+
+    // Results of the chain currently in flight.
+    int pending{ 0 };
+    bool has_fill{ false };
+    int fill_res{ 0 };
+    int drain_res{ 0 };
+    bool wait_writable{ false };
+
+    asio::any_io_executor executor;
+    Handler handler;
+    std::atomic<uint64_t>* progress{ nullptr };
+
+    Op fill_op{ this, Op::Kind::fill };
+    Op drain_op{ this, Op::Kind::drain };
+    Op poll_op{ this, Op::Kind::poll };
+  };
+
+  Impl(asio::io_context& ioc, const Options& options)
+    : options_(options)
+    , event_(ioc)
+  {
+    if (int res{ io_uring_queue_init(options_.queue_depth, &ring_, 0) }; res < 0) {
+      throw std::system_error(-res, std::system_category(), "io_uring_queue_init");
+    }
+
+    event_fd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (event_fd_ < 0 || io_uring_register_eventfd(&ring_, event_fd_) < 0) {
+      io_uring_queue_exit(&ring_);
+      throw std::runtime_error("io_uring: eventfd registration failed");
+    }
+
+    if (io_uring_register_files_sparse(&ring_, options_.max_files) < 0) {
+      io_uring_queue_exit(&ring_);
+      ::close(event_fd_);
+      throw std::runtime_error("io_uring: fixed file table registration failed");
+    }
+    for (unsigned i{ options_.max_files }; i > 0; --i) {
+      free_slots_.push_back(static_cast<int>(i - 1));
+    }
+
+    // Registered buffers back every transfer that cannot splice (the
+    // filesystem refuses, or pipe2 fails). Without them such a transfer
+    // would wait for a buffer that never comes, so refuse to run at all.
+    std::vector<iovec> iovecs;
+    for (std::size_t i{ 0 }; i < options_.buffer_count; ++i) {
+      void* memory{ std::aligned_alloc(4096, options_.buffer_size) };
+      if (!memory) break;
+      buffers_.push_back(static_cast<char*>(memory));
+      iovecs.push_back({ memory, options_.buffer_size });
+    }
+    if (iovecs.empty() ||
+        io_uring_register_buffers(&ring_, iovecs.data(), static_cast<unsigned>(iovecs.size())) < 0) {
+      for (char* buffer : buffers_) {
+        std::free(buffer);
+      }
+      io_uring_queue_exit(&ring_);
+      ::close(event_fd_);
+      throw std::runtime_error("io_uring: buffer registration failed");
+    }
+    for (std::size_t i{ buffers_.size() }; i > 0; --i) {
+      free_buffers_.push_back(static_cast<int>(i - 1));
+    }
+
+    event_.assign(event_fd_);
+    this->wait_for_completions();
+  }
+
+  ~Impl() {
+    beast::error_code ec;
+    event_.cancel(ec);
+    event_.release();
+
+    io_uring_queue_exit(&ring_);
+    ::close(event_fd_);
+
+    for (char* buffer : buffers_) {
+      std::free(buffer);
+    }
+    for (Transfer* transfer : live_) {
+      this->close_pipe(*transfer);
+      delete transfer;
+    }
+  }
+
+  void start(Transfer* transfer) {
+    std::lock_guard lock(mutex_);
+
+    live_.push_back(transfer);
+    this->resume(*transfer);
+    io_uring_submit(&ring_);
+  }
+
+private:
+  void wait_for_completions() {
+    event_.async_read_some(
+      asio::buffer(&event_count_, sizeof(event_count_)),
+      [this](beast::error_code ec, std::size_t) {
+        if (ec == asio::error::operation_aborted) return;
+        this->reap();
+        this->wait_for_completions();
+      }
+    );
+  }
+
+  void reap() {
+    std::lock_guard lock(mutex_);
+
+    io_uring_cqe* cqe{ nullptr };
+    while (io_uring_peek_cqe(&ring_, &cqe) == 0) {
+      auto* op{ static_cast<Op*>(io_uring_cqe_get_data(cqe)) };
+      int res{ cqe->res };
+      io_uring_cqe_seen(&ring_, cqe);
+
+      if (!op) continue;
+
+      Transfer& transfer{ *op->transfer };
+      switch (op->kind) {
+        case Op::Kind::fill:  transfer.fill_res = res; break;
+        case Op::Kind::drain: transfer.drain_res = res; break;
+        case Op::Kind::poll:  break;
+      }
+
+      if (--transfer.pending == 0) {
+        this->on_step(transfer);
+      }
+    }
+
+    io_uring_submit(&ring_);
+  }
+
+  // False with `ec` clear means "wait for a slot or buffer to free up";
+  // with `ec` set the transfer can never proceed and must be failed.
+  bool acquire_resources(Transfer& transfer, beast::error_code& ec) {
+    if (transfer.slot < 0) {
+      if (free_slots_.empty()) return false;
+
+      int slot{ free_slots_.back() };
+      if (int res{ io_uring_register_files_update(&ring_, static_cast<unsigned>(slot), &transfer.file_fd, 1) }; res < 0) {
+        LOG_WARN("io_uring: could not register file: ", from_result(res).message());
+        ec = asio::error::operation_not_supported;
+        return false;
+      }
+      free_slots_.pop_back();
+      transfer.slot = slot;
+    }
+
+    if (transfer.use_splice && transfer.pipe_fds[0] < 0) {
+      if (::pipe2(transfer.pipe_fds, O_CLOEXEC) < 0) {
+        transfer.use_splice = false;
+      } else {
+        ::fcntl(transfer.pipe_fds[1], F_SETPIPE_SZ, pipe_capacity);
+      }
+    }
+
+    if (!transfer.use_splice && transfer.buffer < 0) {
+      if (free_buffers_.empty()) return false;
+      transfer.buffer = free_buffers_.back();
+      free_buffers_.pop_back();
+    }
+
+    return true;
+  }
+
+  io_uring_sqe* next_sqe() {
+    io_uring_sqe* sqe{ io_uring_get_sqe(&ring_) };
+    if (!sqe) {
+      io_uring_submit(&ring_);
+      sqe = io_uring_get_sqe(&ring_);
+    }
+    return sqe;
+  }
+
+  uint32_t chunk_limit(const Transfer& transfer) const {
+    return transfer.use_splice
+      ? pipe_capacity
+      : static_cast<uint32_t>(options_.buffer_size);
+  }
+
+  // Queues the next chain: [poll ->] [fill ->] drain.
+  void submit_step(Transfer& transfer) {
+    uint32_t unsent{ transfer.staged - transfer.staged_sent };
+
+    if (unsent == 0 && transfer.remaining == 0) {
+      return this->complete(transfer, {});
+    }
+
+    transfer.pending = 0;
+    transfer.has_fill = false;
+    transfer.fill_res = 0;
+    transfer.drain_res = 0;
+
+    if (transfer.wait_writable) {
+      transfer.wait_writable = false;
+
+      io_uring_sqe* sqe{ this->next_sqe() };
+      io_uring_prep_poll_add(sqe, transfer.socket_fd, POLLOUT);
+      io_uring_sqe_set_data(sqe, &transfer.poll_op);
+      io_uring_sqe_set_flags(sqe, IOSQE_IO_LINK);
+      ++transfer.pending;
+    }
+
+    uint32_t length{ unsent };
+
+    if (unsent == 0) {
+      length = static_cast<uint32_t>(
+        std::min<uint64_t>(transfer.remaining, this->chunk_limit(transfer))
+      );
+      transfer.staged = 0;
+      transfer.staged_sent = 0;
+      transfer.has_fill = true;
+
+      io_uring_sqe* sqe{ this->next_sqe() };
+      if (transfer.use_splice) {
+        io_uring_prep_splice(
+          sqe, transfer.slot, static_cast<int64_t>(transfer.offset),
+          transfer.pipe_fds[1], -1, length, SPLICE_F_FD_IN_FIXED
+        );
+        io_uring_sqe_set_flags(sqe, IOSQE_IO_LINK);
+      } else {
+        io_uring_prep_read_fixed(
+          sqe, transfer.slot, buffers_[transfer.buffer], length,
+          transfer.offset, transfer.buffer
+        );
+        io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE | IOSQE_IO_LINK);
+      }
+      io_uring_sqe_set_data(sqe, &transfer.fill_op);
+      ++transfer.pending;
+    }
+
+    io_uring_sqe* sqe{ this->next_sqe() };
+    if (transfer.use_splice) {
+      io_uring_prep_splice(
+        sqe, transfer.pipe_fds[0], -1, transfer.socket_fd, -1, length, 0
+      );
+    } else {
+      io_uring_prep_send(
+        sqe, transfer.socket_fd, buffers_[transfer.buffer] + transfer.staged_sent,
+        length, MSG_NOSIGNAL
+      );
+    }
+    io_uring_sqe_set_data(sqe, &transfer.drain_op);
+    ++transfer.pending;
+  }
+
+  void on_step(Transfer& transfer) {
+    if (transfer.has_fill) {
+      if (transfer.fill_res == -EINVAL && transfer.use_splice) {
+        // Filesystem cannot splice: retry through a registered buffer.
+        this->close_pipe(transfer);
+        transfer.use_splice = false;
+        return this->resume(transfer);
+      }
+      if (transfer.fill_res < 0) {
+        return this->complete(transfer, from_result(transfer.fill_res));
+      }
+      if (transfer.fill_res == 0) {
+        return this->complete(transfer, asio::error::eof);
+      }
+
+      transfer.staged = static_cast<uint32_t>(transfer.fill_res);
+      transfer.staged_sent = 0;
+      transfer.offset += transfer.staged;
+      transfer.remaining -= transfer.staged;
+    }
+
+    if (transfer.drain_res > 0) {
+      transfer.staged_sent += static_cast<uint32_t>(transfer.drain_res);
+      transfer.sent += static_cast<uint64_t>(transfer.drain_res);
+      if (transfer.progress) {
+        transfer.progress->fetch_add(static_cast<uint64_t>(transfer.drain_res), std::memory_order_relaxed);
+      }
+    } else if (transfer.drain_res == -EAGAIN) {
+      transfer.wait_writable = true;
+    } else if (transfer.drain_res == 0 || transfer.drain_res != -ECANCELED) {
+      // -ECANCELED only means a short fill broke the link; anything else is fatal.
+      return this->complete(
+        transfer,
+        transfer.drain_res == 0 ? beast::error_code(asio::error::eof) : from_result(transfer.drain_res)
+      );
+    }
+
+    if (transfer.staged_sent == transfer.staged) {
+      transfer.staged = 0;
+      transfer.staged_sent = 0;
+    }
+
+    this->submit_step(transfer);
+  }
+
+  void resume(Transfer& transfer) {
+    beast::error_code ec;
+    if (!this->acquire_resources(transfer, ec)) {
+      if (ec) return this->complete(transfer, ec);
+      waiting_.push_back(&transfer);
+      return;
+    }
+    this->submit_step(transfer);
+  }
+
+  void complete(Transfer& transfer, beast::error_code ec) {
+    if (transfer.slot >= 0) {
+      int empty{ -1 };
+      io_uring_register_files_update(&ring_, static_cast<unsigned>(transfer.slot), &empty, 1);
+      free_slots_.push_back(transfer.slot);
+    }
+    if (transfer.buffer >= 0) {
+      free_buffers_.push_back(transfer.buffer);
+    }
+    this->close_pipe(transfer);
+
+    live_.erase(std::find(live_.begin(), live_.end(), &transfer));
+
+    asio::post(
+      transfer.executor,
+      [handler = std::move(transfer.handler), ec, sent = transfer.sent] {
+        handler(ec, sent);
+      }
+    );
+    delete &transfer;
+
+    // Freed a slot or buffer; let a parked transfer proceed.
+    if (!waiting_.empty()) {
+      Transfer* next{ waiting_.front() };
+      waiting_.pop_front();
+      this->resume(*next);
+    }
+  }
+
+  void close_pipe(Transfer& transfer) {
+    for (int& fd : transfer.pipe_fds) {
+      if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+      }
+    }
+  }
+
+  Options options_;
+  io_uring ring_{};
+  int event_fd_{ -1 };
+  uint64_t event_count_{ 0 };
+  asio::posix::stream_descriptor event_;
+
+  std::mutex mutex_;
+  std::vector<char*> buffers_;
+  std::vector<int> free_buffers_;
+  std::vector<int> free_slots_;
+  std::vector<Transfer*> live_;
+  std::deque<Transfer*> waiting_;
+};
+
+IoUringEngine::IoUringEngine(asio::io_context& ioc, const Options& options)
+  : impl_(std::make_unique<Impl>(ioc, options))
+{}
+
+IoUringEngine::~IoUringEngine() = default;
+
+bool IoUringEngine::is_available() {
+  io_uring ring{};
+  if (io_uring_queue_init(2, &ring, 0) < 0) {
+    return false;
+  }
+  io_uring_queue_exit(&ring);
+  return true;
+}
+
+void IoUringEngine::async_send_file(
+  int                     socket_fd,
+  int                     file_fd,
+  uint64_t                offset,
+  uint64_t                length,
+  asio::any_io_executor   executor,
+  Handler                 handler,
+  std::atomic<uint64_t>*  progress
+) {
+  auto* transfer{ new Impl::Transfer{} };
+  transfer->socket_fd = socket_fd;
+  transfer->file_fd = file_fd;
+  transfer->offset = offset;
+  transfer->remaining = length;
+  transfer->executor = std::move(executor);
+  transfer->handler = std::move(handler);
+  transfer->progress = progress;
+
+  impl_->start(transfer);
+}
+
+#else
+
+struct IoUringEngine::Impl {};
+
+IoUringEngine::IoUringEngine(asio::io_context&, const Options&) {
+  throw std::runtime_error("Venturi was built without io_uring support");
+}
+
+IoUringEngine::~IoUringEngine() = default;
+
+bool IoUringEngine::is_available() { return false; }
+
+void IoUringEngine::async_send_file(
+  int,
+  int,
+  uint64_t,
+  uint64_t,
+  asio::any_io_executor   executor,
+  Handler                 handler,
+  std::atomic<uint64_t>*
+) {
+  asio::post(executor, [handler = std::move(handler)] {
+    handler(asio::error::operation_not_supported, 0);
+  });
+}
+
+#endif
+
+} // namespace venturi::adapters
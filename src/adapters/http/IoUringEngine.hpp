@@ -0,0 +1,67 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <boost/beast/core/error.hpp>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace venturi::adapters {
+
+namespace beast = boost::beast;
+namespace asio = boost::asio;
+
+// Optional disk-to-socket engine built on io_uring.
+//
+// Every file region is moved as a chain of linked SQEs: a splice from the
+// file into a per-transfer pipe linked to a splice from the pipe into the
+// socket or, where the filesystem cannot splice, a READ_FIXED into a
+// registered buffer linked to a SEND. Files live in the ring's fixed file
+// table for the duration of a transfer. Completions are reaped on the owning
+// io_context through an eventfd, so a cold read never blocks an I/O thread.
+//
+// Only functional when built with VENTURI_ENABLE_IO_URING; otherwise
+// is_available() is false and construction throws. Construction also throws
+// when the ring, fixed file table or registered buffers cannot be set up.
+class IoUringEngine {
+public:
+  using Handler = std::function<void(beast::error_code, uint64_t)>;
+
+  struct Options {
+    unsigned      queue_depth{ 256 };
+    unsigned      max_files{ 1024 };
+    std::size_t   buffer_count{ 64 };
+    std::size_t   buffer_size{ 256 * 1024 };
+  };
+
+  IoUringEngine(asio::io_context& ioc, const Options& options);
+  ~IoUringEngine();
+
+  IoUringEngine(const IoUringEngine&) = delete;
+  IoUringEngine& operator=(const IoUringEngine&) = delete;
+
+  // True when built with liburing and the running kernel can set up a ring.
+  static bool is_available();
+
+  // Sends [offset, offset + length) of `file_fd` to `socket_fd`. The handler
+  // runs on `executor` with the number of bytes sent. `file_fd` must stay
+  // open until then. operation_not_supported means the engine could not
+  // take the transfer and sent nothing; the caller should use another path.
+  // When given, `progress` is bumped (from the engine's thread) as bytes
+  // reach the socket and must outlive the handler call.
+  void async_send_file(
+    int                     socket_fd,
+    int                     file_fd,
+    uint64_t                offset,
+    uint64_t                length,
+    asio::any_io_executor   executor,
+    Handler                 handler,
+    std::atomic<uint64_t>*  progress = nullptr
+  );
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+} // namespace venturi::adapters
@@ -0,0 +1,391 @@
+#include "RangeStreamer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+
+namespace venturi::adapters {
+
+RangeStreamer::RangeStreamer(
+  tcp::socket&              socket,
+  FileHandle                file,
+  std::vector<BodySegment>  segments,
+  IoUringEngine*            engine
+)
+  : socket_(socket)
+  , file_(std::move(file))
+  , segments_(std::move(segments))
+  , engine_(engine)
+  , idle_timer_(socket.get_executor())
+{}
+
+void RangeStreamer::use_block_cache(BlockCache& cache, BlockCache::Source source) {
+  block_cache_ = &cache;
+  source_ = std::move(source);
+}
+
+void RangeStreamer::use_direct_io(FileHandle direct_file, MediaReader& reader) {
+  direct_file_ = std::move(direct_file);
+  direct_reader_ = &reader;
+}
+
+void RangeStreamer::start(Handler handler) {
+  handler_ = std::move(handler);
+
+  beast::error_code ec;
+  socket_.native_non_blocking(true, ec);
+  if (ec) {
+    return this->finish(ec);
+  }
+
+#if !defined(__linux__)
+  buffer_.resize(64 * 1024);
+#endif
+
+  if (idle_timeout_ > std::chrono::steady_clock::duration::zero()) {
+    idle_since_ = std::chrono::steady_clock::now();
+    this->arm_idle_timer();
+  }
+
+  index_ = 0;
+  this->next_segment();
+}
+
+void RangeStreamer::next_segment() {
+  while (index_ < segments_.size() && segments_[index_].size() == 0) {
+    ++index_;
+  }
+
+  if (index_ == segments_.size()) {
+    return this->finish({});
+  }
+
+  const BodySegment& segment{ segments_[index_] };
+  if (segment.kind == BodySegment::Kind::memory) {
+    return this->send_memory();
+  }
+
+  offset_ = segment.offset;
+  remaining_ = segment.length;
+
+  if (segment.read_path == BodySegment::ReadPath::block_cache && block_cache_) {
+    return this->send_cached();
+  }
+
+  if (segment.read_path == BodySegment::ReadPath::direct && direct_reader_) {
+    return this->send_direct();
+  }
+
+  if (engine_) {
+    return this->send_file_io_uring();
+  }
+
+  this->send_file();
+}
+
+void RangeStreamer::send_file_io_uring() {
+  engine_->async_send_file(
+    socket_.native_handle(),
+    file_.native_handle(),
+    offset_,
+    remaining_,
+    socket_.get_executor(),
+    [self = shared_from_this()](beast::error_code ec, uint64_t sent) {
+      if (ec == asio::error::operation_not_supported && sent == 0) {
+        return self->send_file();
+      }
+
+      self->sent_ += sent;
+      self->offset_ += sent;
+      self->report_progress();
+      if (ec) return self->finish(ec);
+
+      ++self->index_;
+      self->next_segment();
+    },
+    &engine_sent_
+  );
+}
+
+void RangeStreamer::send_memory() {
+  asio::async_write(
+    socket_,
+    segments_[index_].memory,
+    [self = shared_from_this()](beast::error_code ec, std::size_t written) {
+      if (ec) return self->finish(ec);
+
+      self->sent_ += written;
+      self->segments_[self->index_].owner.reset();
+      ++self->index_;
+      self->next_segment();
+    }
+  );
+}
+
+void RangeStreamer::send_cached() {
+  if (remaining_ == 0) {
+    ++index_;
+    return this->next_segment();
+  }
+
+  const uint64_t block_size{ block_cache_->block_size() };
+  const uint64_t index{ offset_ / block_size };
+
+  // Keep the next block coming while this one drains.
+  if ((index + 1) * block_size < offset_ + remaining_) {
+    block_cache_->prefetch(*source_, index + 1);
+  }
+
+  block_cache_->async_get(
+    *source_,
+    index,
+    socket_.get_executor(),
+    [self = shared_from_this(), index, block_size](
+      std::error_code ec,
+      std::shared_ptr<const BlockCache::Block> block
+    ) {
+      if (ec) {
+        return self->finish(beast::error_code(ec.value(), beast::system_category()));
+      }
+
+      const uint64_t within{ self->offset_ - index * block_size };
+      if (within >= block->size()) {
+        return self->finish(asio::error::eof);
+      }
+
+      const std::size_t count{ static_cast<std::size_t>(
+        std::min<uint64_t>(block->size() - within, self->remaining_)
+      ) };
+
+      asio::async_write(
+        self->socket_,
+        asio::buffer(block->data() + within, count),
+        [self, block](beast::error_code ec, std::size_t written) {
+          if (ec) return self->finish(ec);
+
+          self->offset_ += written;
+          self->remaining_ -= written;
+          self->sent_ += written;
+          self->report_progress();
+          self->send_cached();
+        }
+      );
+    }
+  );
+}
+
+void RangeStreamer::send_direct() {
+  if (remaining_ == 0) {
+    ++index_;
+    return this->next_segment();
+  }
+
+  direct_reader_->buffer_pool().async_acquire(
+    socket_.get_executor(),
+    [self = shared_from_this()](AlignedBufferPool::Lease buffer) {
+      constexpr uint64_t align{ AlignedBufferPool::alignment };
+      const uint64_t capacity{ self->direct_reader_->buffer_pool().buffer_size() };
+
+      // O_DIRECT wants aligned offsets and lengths: read the aligned
+      // superset and send only the requested bytes out of it.
+      const uint64_t aligned_offset{ self->offset_ & ~(align - 1) };
+      const uint64_t skip{ self->offset_ - aligned_offset };
+      const uint64_t wanted{ (skip + self->remaining_ + align - 1) & ~(align - 1) };
+      const std::size_t length{ static_cast<std::size_t>(std::min(wanted, capacity)) };
+
+      asio::post(
+        self->direct_reader_->disk_pool(),
+        [self, buffer, aligned_offset, skip, length] {
+          ssize_t n;
+          do {
+            n = ::pread(self->direct_file_.native_handle(), buffer.get(), length,
+                        static_cast<off_t>(aligned_offset));
+          } while (n < 0 && errno == EINTR);
+
+          beast::error_code ec;
+          std::size_t usable{ 0 };
+          if (n < 0) {
+            ec.assign(errno, beast::system_category());
+          } else if (static_cast<uint64_t>(n) <= skip) {
+            ec = asio::error::eof;
+          } else {
+            usable = static_cast<std::size_t>(
+              std::min<uint64_t>(static_cast<uint64_t>(n) - skip, self->remaining_)
+            );
+          }
+
+          asio::post(self->socket_.get_executor(), [self, buffer, skip, usable, ec] {
+            if (ec) return self->finish(ec);
+
+            asio::async_write(
+              self->socket_,
+              asio::buffer(buffer.get() + skip, usable),
+              [self, buffer](beast::error_code ec, std::size_t written) {
+                if (ec) return self->finish(ec);
+
+                self->offset_ += written;
+                self->remaining_ -= written;
+                self->sent_ += written;
+                self->send_direct();
+              }
+            );
+          });
+        }
+      );
+    }
+  );
+}
+
+#if defined(__linux__)
+
+void RangeStreamer::send_file() {
+  uint64_t budget{ max_bytes_per_turn };
+
+  while (remaining_ > 0) {
+    if (budget == 0) {
+      this->report_progress();
+
+      // Yield to other connections sharing this thread.
+      return asio::post(
+        socket_.get_executor(),
+        [self = shared_from_this()] { self->send_file(); }
+      );
+    }
+
+    off_t offset{ static_cast<off_t>(offset_) };
+    std::size_t count{ static_cast<std::size_t>(std::min(remaining_, budget)) };
+
+    ssize_t n{ ::sendfile(socket_.native_handle(), file_.native_handle(), &offset, count) };
+
+    if (n > 0) {
+      offset_ += static_cast<uint64_t>(n);
+      remaining_ -= static_cast<uint64_t>(n);
+      sent_ += static_cast<uint64_t>(n);
+      budget -= std::min(budget, static_cast<uint64_t>(n));
+      continue;
+    }
+
+    if (n == 0) {
+      // File shrank underneath us; the promised Content-Length cannot be met.
+      return this->finish(asio::error::eof);
+    }
+
+    if (errno == EINTR) {
+      continue;
+    }
+
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      this->report_progress();
+      return this->wait_writable();
+    }
+
+    return this->finish(beast::error_code(errno, beast::system_category()));
+  }
+
+  this->report_progress();
+  ++index_;
+  this->next_segment();
+}
+
+#else
+
+void RangeStreamer::send_file() {
+  if (remaining_ == 0) {
+    ++index_;
+    return this->next_segment();
+  }
+
+  std::size_t count{ static_cast<std::size_t>(
+    std::min<uint64_t>(remaining_, buffer_.size())
+  ) };
+
+  ssize_t n{ ::pread(file_.native_handle(), buffer_.data(), count, static_cast<off_t>(offset_)) };
+  if (n < 0) {
+    if (errno == EINTR) return this->send_file();
+    return this->finish(beast::error_code(errno, beast::system_category()));
+  }
+  if (n == 0) {
+    return this->finish(asio::error::eof);
+  }
+
+  asio::async_write(
+    socket_,
+    asio::buffer(buffer_.data(), static_cast<std::size_t>(n)),
+    [self = shared_from_this()](beast::error_code ec, std::size_t written) {
+      if (ec) return self->finish(ec);
+
+      self->offset_ += written;
+      self->remaining_ -= written;
+      self->sent_ += written;
+      self->report_progress();
+      self->send_file();
+    }
+  );
+}
+
+#endif
+
+void RangeStreamer::wait_writable() {
+  socket_.async_wait(
+    tcp::socket::wait_write,
+    [self = shared_from_this()](beast::error_code ec) {
+      if (ec) return self->finish(ec);
+      self->send_file();
+    }
+  );
+}
+
+void RangeStreamer::arm_idle_timer() {
+  // A stall is caught within 1.25x the timeout without touching the timer
+  // on every send.
+  idle_timer_.expires_after(idle_timeout_ / 4);
+  idle_timer_.async_wait([self = shared_from_this()](beast::error_code ec) {
+    if (ec || !self->handler_) return;
+
+    const auto now{ std::chrono::steady_clock::now() };
+    const uint64_t progress{ self->sent_ + self->engine_sent_.load(std::memory_order_relaxed) };
+    if (progress != self->idle_mark_) {
+      self->idle_mark_ = progress;
+      self->idle_since_ = now;
+    }
+    if (now - self->idle_since_ < self->idle_timeout_) {
+      return self->arm_idle_timer();
+    }
+
+    // Shutting down (rather than closing) fails the pending write, poll or
+    // io_uring send without handing the descriptor number to anyone else.
+    self->timed_out_ = true;
+    beast::error_code ignored;
+    self->socket_.shutdown(tcp::socket::shutdown_both, ignored);
+  });
+}
+
+void RangeStreamer::report_progress() {
+  if (on_progress_) {
+    on_progress_(offset_);
+  }
+}
+
+void RangeStreamer::finish(beast::error_code ec) {
+  idle_timer_.cancel();
+  if (timed_out_) {
+    ec = asio::error::timed_out;
+  }
+
+  file_.close();
+  direct_file_.close();
+  segments_.clear();
+
+  if (handler_) {
+    auto handler{ std::move(handler_) };
+    handler_ = nullptr;
+    handler(ec, sent_);
+  }
+}
+
+} // namespace venturi::adapters
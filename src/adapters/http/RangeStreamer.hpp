@@ -0,0 +1,166 @@
+#pragma once
+#include "../storage/FileHandle.hpp"
+#include "../storage/BlockCache.hpp"
+#include "../storage/MediaReader.hpp"
+#include "IoUringEngine.hpp"
+
+#include <boost/asio.hpp>
+#include <boost/beast/core/error.hpp>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace venturi::adapters {
+
+namespace beast = boost::beast;
+namespace asio = boost::asio;
+using tcp = asio::ip::tcp;
+
+// One piece of a response body: either bytes already in memory or a
+// region of the streamer's file.
+struct BodySegment {
+  enum class Kind { memory, file };
+
+  // How a file region reaches the socket.
+  enum class ReadPath {
+    kernel,       // sendfile(2) / io_uring straight from the page cache
+    block_cache,  // shared BlockCache blocks
+    direct,       // O_DIRECT reads into aligned pool buffers
+  };
+
+  Kind kind{ Kind::file };
+
+  // Kind::memory - `owner` keeps the bytes behind `memory` alive.
+  asio::const_buffer memory;
+  std::shared_ptr<const void> owner;
+
+  // Kind::file
+  uint64_t offset{ 0 };
+  uint64_t length{ 0 };
+  ReadPath read_path{ ReadPath::kernel };
+
+  static BodySegment text(std::string text) {
+    auto owned{ std::make_shared<const std::string>(std::move(text)) };
+
+    BodySegment segment;
+    segment.kind = Kind::memory;
+    segment.memory = asio::buffer(*owned);
+    segment.owner = std::move(owned);
+    return segment;
+  }
+
+  // Bytes owned by someone else; `owner` must keep them alive.
+  static BodySegment view(asio::const_buffer bytes, std::shared_ptr<const void> owner) {
+    BodySegment segment;
+    segment.kind = Kind::memory;
+    segment.memory = bytes;
+    segment.owner = std::move(owner);
+    return segment;
+  }
+
+  static BodySegment file(uint64_t offset, uint64_t length) {
+    BodySegment segment;
+    segment.kind = Kind::file;
+    segment.offset = offset;
+    segment.length = length;
+    return segment;
+  }
+
+  uint64_t size() const {
+    return kind == Kind::memory ? memory.size() : length;
+  }
+};
+
+// Writes a sequence of body segments to a socket.
+//
+// File regions go straight from the page cache to the socket with
+// sendfile(2) on Linux, or are handed to an IoUringEngine when one is given;
+// elsewhere they are copied through a small pread() buffer. Regions with a
+// different ReadPath are assembled from the shared BlockCache or read with
+// O_DIRECT instead. The response header must already have been written by
+// the caller.
+//
+// With an idle timeout set, a client that stops reading for that long has
+// its socket shut down, which fails whatever send is pending.
+class RangeStreamer : public std::enable_shared_from_this<RangeStreamer> {
+public:
+  using Handler = std::function<void(beast::error_code, uint64_t)>;
+  using ProgressHandler = std::function<void(uint64_t)>;
+
+  RangeStreamer(
+    tcp::socket&              socket,
+    FileHandle                file,
+    std::vector<BodySegment>  segments,
+    IoUringEngine*            engine = nullptr
+  );
+
+  // Serves ReadPath::block_cache segments from `cache`.
+  void use_block_cache(BlockCache& cache, BlockCache::Source source);
+
+  // Serves ReadPath::direct segments by reading `direct_file` (opened with
+  // O_DIRECT) into `reader`'s aligned buffers on its disk pool.
+  void use_direct_io(FileHandle direct_file, MediaReader& reader);
+
+  // Called with the file offset reached whenever a file region advances.
+  void on_progress(ProgressHandler handler) { on_progress_ = std::move(handler); }
+
+  // Gives up with timed_out when no byte goes out for `timeout`; zero disables.
+  void set_idle_timeout(std::chrono::steady_clock::duration timeout) { idle_timeout_ = timeout; }
+
+  // Streams every segment in order and calls `handler` with the bytes sent.
+  void start(Handler handler);
+
+private:
+  void next_segment();
+  void send_memory();
+  void send_file();
+  void send_file_io_uring();
+  void send_cached();
+  void send_direct();
+  void wait_writable();
+  void arm_idle_timer();
+  void report_progress();
+  void finish(beast::error_code ec);
+
+  // Upper bound of bytes pushed per handler invocation, so that a fast
+  // reader cannot monopolise an I/O thread.
+  static constexpr uint64_t max_bytes_per_turn{ 4 * 1024 * 1024 };
+
+  tcp::socket& socket_;
+  FileHandle file_;
+  std::vector<BodySegment> segments_;
+  std::size_t index_{ 0 };
+  IoUringEngine* engine_;
+  BlockCache* block_cache_{ nullptr };
+  std::optional<BlockCache::Source> source_;
+  FileHandle direct_file_;
+  MediaReader* direct_reader_{ nullptr };
+
+  // Progress within the current file segment.
+  uint64_t offset_{ 0 };
+  uint64_t remaining_{ 0 };
+
+  uint64_t sent_{ 0 };
+  Handler handler_;
+  ProgressHandler on_progress_;
+
+  // Idle detection: the timer ticks a few times per timeout and notes when
+  // progress last moved. The engine reports its bytes from its own thread,
+  // hence the atomic.
+  asio::steady_timer idle_timer_;
+  std::chrono::steady_clock::duration idle_timeout_{};
+  std::chrono::steady_clock::time_point idle_since_;
+  std::atomic<uint64_t> engine_sent_{ 0 };
+  uint64_t idle_mark_{ 0 };
+  bool timed_out_{ false };
+
+#if !defined(__linux__)
+  std::vector<char> buffer_;
+#endif
+};
+
+} // namespace venturi::adapters
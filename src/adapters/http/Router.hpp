@@ -0,0 +1,191 @@
+#pragma once
+#include <boost/beast/http/verb.hpp>
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+namespace venturi::adapters {
+
+namespace http = boost::beast::http;
+
+// Path parameters and query string of a matched request. Every view points
+// into the request target, so a match must not outlive the request.
+struct RouteParams {
+  static constexpr std::size_t max_params{ 2 };
+
+  std::array<std::string_view, max_params> values{};
+  std::size_t count{ 0 };
+  std::string_view query;
+
+  std::string_view operator[](std::size_t index) const { return values[index]; }
+};
+
+// Returns the raw value of `key` in an `a=1&b=2` query string, or nullopt if
+// the key is absent. A key without "=" yields an empty value.
+constexpr std::optional<std::string_view> query_param(
+  std::string_view  query,
+  std::string_view  key
+) {
+  while (!query.empty()) {
+    std::size_t end{ query.find('&') };
+    std::string_view pair{ query.substr(0, end) };
+    query = end == std::string_view::npos ? std::string_view{} : query.substr(end + 1);
+
+    std::size_t eq{ pair.find('=') };
+    if (pair.substr(0, eq) == key) {
+      return eq == std::string_view::npos ? std::string_view{} : pair.substr(eq + 1);
+    }
+  }
+  return std::nullopt;
+}
+
+// One entry of a route table: a method plus a path pattern such as
+// "/api/media/{id}". Patterns are split and validated at compile time; a
+// "{name}" segment captures one non-empty path segment.
+template <typename Id>
+class Route {
+public:
+  static constexpr std::size_t max_segments{ 8 };
+
+  consteval Route(http::verb method, std::string_view pattern, Id id)
+    : method_{ method }, id_{ id }, pattern_{ pattern } {
+    if (pattern.empty() || pattern.front() != '/') {
+      throw "route pattern must start with '/'";
+    }
+
+    std::string_view rest{ pattern.substr(1) };
+    while (!rest.empty()) {
+      if (segment_count_ == max_segments) {
+        throw "route pattern has too many segments";
+      }
+
+      std::size_t end{ rest.find('/') };
+      std::string_view segment{ rest.substr(0, end) };
+
+      if (segment.empty()) {
+        throw "route pattern has an empty segment";
+      }
+
+      bool capture{ segment.front() == '{' };
+      if (capture != (segment.back() == '}')) {
+        throw "route parameter must span a whole segment";
+      }
+      if (capture && ++param_count_ > RouteParams::max_params) {
+        throw "route pattern has too many parameters";
+      }
+      if (capture && param_count_ == 1) {
+        first_capture_ = segment_count_;
+        prefix_ = pattern.substr(0, segment.data() - pattern.data());
+      }
+
+      segments_[segment_count_] = capture ? std::string_view{} : segment;
+      captures_[segment_count_] = capture;
+      ++segment_count_;
+
+      rest = end == std::string_view::npos ? std::string_view{} : rest.substr(end + 1);
+    }
+  }
+
+  constexpr http::verb method() const { return method_; }
+  constexpr Id id() const { return id_; }
+
+  // Matches `path` (no query string) and collects its parameters.
+  constexpr bool match(std::string_view path, RouteParams& params) const {
+    if (param_count_ == 0) {
+      return path == pattern_;
+    }
+
+    // Everything before the first parameter is a single comparison.
+    if (!path.starts_with(prefix_)) {
+      return false;
+    }
+    path.remove_prefix(prefix_.size());
+
+    params.count = 0;
+    for (std::size_t i{ first_capture_ }; i < segment_count_; ++i) {
+      if (i > first_capture_) {
+        if (path.empty() || path.front() != '/') {
+          return false;
+        }
+        path.remove_prefix(1);
+      }
+
+      std::string_view segment{ path.substr(0, path.find('/')) };
+      if (captures_[i]) {
+        if (segment.empty()) {
+          return false;
+        }
+        params.values[params.count++] = segment;
+      } else if (segment != segments_[i]) {
+        return false;
+      }
+      path.remove_prefix(segment.size());
+    }
+
+    return path.empty();
+  }
+
+private:
+  http::verb method_;
+  Id id_;
+  std::string_view pattern_;
+  std::string_view prefix_;
+  std::array<std::string_view, max_segments> segments_{};
+  std::array<bool, max_segments> captures_{};
+  std::size_t segment_count_{ 0 };
+  std::size_t param_count_{ 0 };
+  std::size_t first_capture_{ 0 };
+};
+
+enum class RouteStatus {
+  matched,
+  not_found,           // no pattern matches the path
+  method_not_allowed,  // the path matches, but only for other methods
+};
+
+template <typename Id>
+struct RouteResult {
+  RouteStatus status{ RouteStatus::not_found };
+  Id id{};
+  RouteParams params;
+};
+
+// Dispatches a request target against a fixed table of routes. Matching
+// compares string_views into the target and never allocates; literal
+// routes cost one comparison and parameterised ones a prefix comparison
+// plus a walk over the remaining segments. Tables are small, so an ordered
+// scan beats a trie here.
+template <typename Id, std::size_t N>
+class Router {
+public:
+  consteval explicit Router(const std::array<Route<Id>, N>& routes)
+    : routes_{ routes } {}
+
+  constexpr RouteResult<Id> match(http::verb method, std::string_view target) const {
+    RouteResult<Id> result;
+
+    std::string_view path{ target.substr(0, target.find('?')) };
+    if (path.size() < target.size()) {
+      result.params.query = target.substr(path.size() + 1);
+    }
+
+    for (const auto& route : routes_) {
+      if (route.match(path, result.params)) {
+        if (route.method() == method) {
+          result.status = RouteStatus::matched;
+          result.id = route.id();
+          return result;
+        }
+        result.status = RouteStatus::method_not_allowed;
+      }
+    }
+
+    return result;
+  }
+
+private:
+  std::array<Route<Id>, N> routes_;
+};
+
+} // namespace venturi::adapters
@@ -0,0 +1,68 @@
+#include "AlignedBufferPool.hpp"
+
+#include <boost/asio/post.hpp>
+#include <cstdlib>
+#include <new>
+
+namespace venturi::adapters {
+
+AlignedBufferPool::AlignedBufferPool(std::size_t buffer_size, std::size_t buffer_count)
+  : buffer_size_((buffer_size + alignment - 1) / alignment * alignment)
+{
+  buffers_.reserve(buffer_count);
+  for (std::size_t i{ 0 }; i < buffer_count; ++i) {
+    void* memory{ std::aligned_alloc(alignment, buffer_size_) };
+    if (!memory) {
+      throw std::bad_alloc();
+    }
+    buffers_.push_back(static_cast<char*>(memory));
+  }
+  free_ = buffers_;
+}
+
+AlignedBufferPool::~AlignedBufferPool() {
+  for (char* buffer : buffers_) {
+    std::free(buffer);
+  }
+}
+
+void AlignedBufferPool::async_acquire(asio::any_io_executor executor, Handler handler) {
+  std::unique_lock lock(mutex_);
+
+  if (free_.empty()) {
+    waiters_.push_back(Waiter{ std::move(executor), std::move(handler) });
+    return;
+  }
+
+  char* data{ free_.back() };
+  free_.pop_back();
+  lock.unlock();
+
+  asio::post(executor, [this, handler = std::move(handler), data] {
+    handler(this->make_lease(data));
+  });
+}
+
+AlignedBufferPool::Lease AlignedBufferPool::make_lease(char* data) {
+  return Lease(data, [this](char* data) { this->release(data); });
+}
+
+void AlignedBufferPool::release(char* data) {
+  std::unique_lock lock(mutex_);
+
+  if (waiters_.empty()) {
+    free_.push_back(data);
+    return;
+  }
+
+  // Hand the buffer straight to the oldest waiter.
+  Waiter waiter{ std::move(waiters_.front()) };
+  waiters_.pop_front();
+  lock.unlock();
+
+  asio::post(waiter.executor, [this, handler = std::move(waiter.handler), data] {
+    handler(this->make_lease(data));
+  });
+}
+
+} // namespace venturi::adapters
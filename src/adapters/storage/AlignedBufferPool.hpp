@@ -0,0 +1,55 @@
+#pragma once
+#include <boost/asio/any_io_executor.hpp>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace venturi::adapters {
+
+namespace asio = boost::asio;
+
+// Fixed set of reusable, page-aligned buffers for O_DIRECT reads.
+//
+// Buffers are handed out as leases that return to the pool when the last
+// copy is dropped. When every buffer is out, requests queue up and are
+// served in order as leases come back, which also caps how much memory the
+// direct I/O path can pin.
+class AlignedBufferPool {
+public:
+  static constexpr std::size_t alignment{ 4096 };
+
+  using Lease = std::shared_ptr<char>;
+  using Handler = std::function<void(Lease)>;
+
+  AlignedBufferPool(std::size_t buffer_size, std::size_t buffer_count);
+  ~AlignedBufferPool();
+
+  AlignedBufferPool(const AlignedBufferPool&) = delete;
+  AlignedBufferPool& operator=(const AlignedBufferPool&) = delete;
+
+  // Delivers a buffer to `handler` on `executor`, now or once one is free.
+  void async_acquire(asio::any_io_executor executor, Handler handler);
+
+  std::size_t buffer_size() const { return buffer_size_; }
+
+private:
+  struct Waiter {
+    asio::any_io_executor executor;
+    Handler handler;
+  };
+
+  Lease make_lease(char* data);
+  void release(char* data);
+
+  const std::size_t buffer_size_;
+
+  std::mutex mutex_;
+  std::vector<char*> buffers_;
+  std::vector<char*> free_;
+  std::deque<Waiter> waiters_;
+};
+
+} // namespace venturi::adapters
@@ -0,0 +1,173 @@
+#include "BlockCache.hpp"
+#include "FileHandle.hpp"
+
+#include <boost/asio/post.hpp>
+#include <unistd.h>
+#include <cerrno>
+
+namespace venturi::adapters {
+
+BlockCache::Source BlockCache::Source::from(const core::MediaInfo& media) {
+  return Source{
+    media.id,
+    media.file_path,
+    static_cast<int64_t>(media.modified_at.time_since_epoch().count())
+  };
+}
+
+std::size_t BlockCache::KeyHash::operator()(const Key& key) const {
+  std::size_t hash{ std::hash<core::MediaId>{}(key.media_id) };
+  hash ^= std::hash<uint64_t>{}(key.index) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+  hash ^= std::hash<int64_t>{}(key.version) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+  return hash;
+}
+
+BlockCache::BlockCache(
+  asio::thread_pool&  disk_pool,
+  uint64_t            budget_bytes,
+  std::size_t         block_size
+)
+  : disk_pool_(disk_pool)
+  , block_size_(block_size)
+  , capacity_(block_size > 0 ? static_cast<std::size_t>(budget_bytes / block_size) : 0)
+{
+  ring_.reserve(capacity_);
+}
+
+void BlockCache::async_get(
+  const Source&           source,
+  uint64_t                index,
+  asio::any_io_executor   executor,
+  Handler                 handler
+) {
+  Key key{ source.media_id, source.version, index };
+
+  std::unique_lock lock(mutex_);
+
+  if (auto it = resident_.find(key); it != resident_.end()) {
+    Slot& slot{ ring_[it->second] };
+    slot.referenced = true;
+
+    auto block{ slot.block };
+    lock.unlock();
+
+    return asio::post(executor, [handler = std::move(handler), block = std::move(block)] {
+      handler({}, block);
+    });
+  }
+
+  auto [it, first] = in_flight_.try_emplace(key);
+  it->second.push_back(Waiter{ std::move(executor), std::move(handler) });
+
+  // Everyone after the first miss just joins the pending read.
+  if (first) {
+    lock.unlock();
+    this->start_read(source, key);
+  }
+}
+
+void BlockCache::prefetch(const Source& source, uint64_t index) {
+  Key key{ source.media_id, source.version, index };
+
+  {
+    std::lock_guard lock(mutex_);
+    if (resident_.contains(key) || in_flight_.contains(key)) {
+      return;
+    }
+    in_flight_.try_emplace(key);
+  }
+
+  this->start_read(source, key);
+}
+
+void BlockCache::start_read(const Source& source, const Key& key) {
+  asio::post(disk_pool_, [this, path = source.path, key] {
+    std::error_code ec;
+    FileHandle file{ FileHandle::open_read(path, ec) };
+    if (ec) {
+      return this->on_read(key, ec, nullptr);
+    }
+
+    auto block = std::make_shared<Block>(block_size_);
+    const uint64_t offset{ key.index * block_size_ };
+    std::size_t filled{ 0 };
+
+    while (filled < block->size()) {
+      ssize_t n{ ::pread(
+        file.native_handle(),
+        block->data() + filled,
+        block->size() - filled,
+        static_cast<off_t>(offset + filled)
+      ) };
+
+      if (n < 0 && errno == EINTR) continue;
+      if (n < 0) {
+        return this->on_read(key, std::error_code(errno, std::system_category()), nullptr);
+      }
+      if (n == 0) break;   // last block of the file
+
+      filled += static_cast<std::size_t>(n);
+    }
+
+    if (filled == 0) {
+      return this->on_read(key, std::make_error_code(std::errc::invalid_argument), nullptr);
+    }
+
+    block->resize(filled);
+    this->on_read(key, {}, std::move(block));
+  });
+}
+
+void BlockCache::on_read(
+  const Key&                    key,
+  std::error_code               ec,
+  std::shared_ptr<const Block>  block
+) {
+  std::vector<Waiter> waiters;
+
+  {
+    std::lock_guard lock(mutex_);
+
+    if (auto it = in_flight_.find(key); it != in_flight_.end()) {
+      waiters = std::move(it->second);
+      in_flight_.erase(it);
+    }
+
+    if (!ec) {
+      this->insert(key, block);
+    }
+  }
+
+  for (auto& waiter : waiters) {
+    asio::post(waiter.executor, [handler = std::move(waiter.handler), ec, block] {
+      handler(ec, block);
+    });
+  }
+}
+
+void BlockCache::insert(const Key& key, std::shared_ptr<const Block> block) {
+  if (capacity_ == 0) {
+    return;
+  }
+
+  if (ring_.size() < capacity_) {
+    resident_[key] = ring_.size();
+    ring_.push_back(Slot{ key, std::move(block), false });
+    return;
+  }
+
+  // CLOCK: sweep, clearing reference bits, until an unreferenced victim.
+  while (ring_[hand_].referenced) {
+    ring_[hand_].referenced = false;
+    hand_ = (hand_ + 1) % capacity_;
+  }
+
+  Slot& victim{ ring_[hand_] };
+  resident_.erase(victim.key);
+
+  victim = Slot{ key, std::move(block), false };
+  resident_[key] = hand_;
+  hand_ = (hand_ + 1) % capacity_;
+}
+
+} // namespace venturi::adapters
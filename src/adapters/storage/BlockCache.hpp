@@ -0,0 +1,99 @@
+#pragma once
+#include "../../core/entities/MediaInfo.hpp"
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+namespace venturi::adapters {
+
+namespace asio = boost::asio;
+
+// Fixed-size blocks of media files shared between sessions.
+//
+// Lookups are single-flight: however many sessions miss on the same block
+// at once, one disk read is issued and every waiter receives its result.
+// Resident blocks are evicted with the CLOCK (second chance) policy once the
+// memory budget is reached.
+class BlockCache {
+public:
+  using Block = std::vector<char>;
+  using Handler = std::function<void(std::error_code, std::shared_ptr<const Block>)>;
+
+  // Identifies one version of a file; a new modified_at means new blocks.
+  struct Source {
+    core::MediaId media_id;
+    std::string path;
+    int64_t version{ 0 };
+
+    static Source from(const core::MediaInfo& media);
+  };
+
+  BlockCache(
+    asio::thread_pool&  disk_pool,
+    uint64_t            budget_bytes,
+    std::size_t         block_size
+  );
+
+  // Delivers block `index` of `source` to `handler` on `executor`.
+  void async_get(
+    const Source&           source,
+    uint64_t                index,
+    asio::any_io_executor   executor,
+    Handler                 handler
+  );
+
+  // Starts loading block `index` unless it is resident or in flight.
+  void prefetch(const Source& source, uint64_t index);
+
+  std::size_t block_size() const { return block_size_; }
+  bool enabled() const { return capacity_ > 0; }
+
+private:
+  struct Key {
+    core::MediaId media_id;
+    int64_t version;
+    uint64_t index;
+
+    bool operator==(const Key&) const = default;
+  };
+
+  struct KeyHash {
+    std::size_t operator()(const Key& key) const;
+  };
+
+  struct Slot {
+    Key key;
+    std::shared_ptr<const Block> block;
+    bool referenced{ false };
+  };
+
+  struct Waiter {
+    asio::any_io_executor executor;
+    Handler handler;
+  };
+
+  void start_read(const Source& source, const Key& key);
+  void on_read(const Key& key, std::error_code ec, std::shared_ptr<const Block> block);
+  void insert(const Key& key, std::shared_ptr<const Block> block);
+
+  asio::thread_pool& disk_pool_;
+  const std::size_t block_size_;
+  const std::size_t capacity_;   // in blocks
+
+  std::mutex mutex_;
+  std::vector<Slot> ring_;
+  std::size_t hand_{ 0 };
+  std::unordered_map<Key, std::size_t, KeyHash> resident_;
+  std::unordered_map<Key, std::vector<Waiter>, KeyHash> in_flight_;
+};
+
+} // namespace venturi::adapters
@@ -0,0 +1,338 @@
+#include "CatalogIndex.hpp"
+#include "FileHandle.hpp"
+#include "../../../app/Logger.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <string_view>
+#include <type_traits>
+
+namespace venturi::adapters {
+
+namespace {
+
+constexpr char index_magic[8]{ 'V', 'N', 'T', 'R', 'I', 'D', 'X', '\0' };
+constexpr uint32_t byte_order_mark{ 0x01020304 };
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t entry_count;
+  uint64_t strings_size;
+  uint64_t checksum;          // FNV-1a of records and strings
+  uint32_t root_offset;
+  uint32_t root_length;
+};
+
+struct StringRef {
+  uint32_t offset;
+  uint32_t length;
+};
+
+struct Record {
+  uint64_t inode;
+  uint64_t file_size;
+  int64_t modified_ns;
+  int64_t created_ns;
+  StringRef path;
+  StringRef optimized_path;
+  StringRef mime_type;
+  core::ContainerInfo container;
+};
+
+static_assert(sizeof(FileHeader) == 48);
+static_assert(sizeof(Record) == 160);
+static_assert(std::is_trivially_copyable_v<core::ContainerInfo>);
+
+// Stable across builds and platforms, unlike std::hash.
+uint64_t fnv1a(const char* data, std::size_t size, uint64_t hash = 0xcbf29ce484222325ULL) {
+  for (std::size_t i{ 0 }; i < size; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+int64_t to_ns(std::chrono::system_clock::time_point time) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+std::chrono::system_clock::time_point from_ns(int64_t ns) {
+  return std::chrono::system_clock::time_point{
+    std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds{ ns })
+  };
+}
+
+bool valid_container(const core::ContainerInfo& container) {
+  using Format = core::ContainerInfo::Format;
+  using Kind = core::ContainerInfo::Track::Kind;
+
+  if (container.format > Format::matroska || container.track_count > core::ContainerInfo::max_tracks) {
+    return false;
+  }
+  for (const auto& track : container.tracks) {
+    if (track.kind > Kind::subtitle) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Read-only mapping of a whole file, unmapped on scope exit.
+class MappedFile {
+public:
+  MappedFile(const std::filesystem::path& path, std::error_code& ec) {
+    auto file = FileHandle::open_read(path, ec);
+    if (ec) {
+      return;
+    }
+
+    auto size = file.size(ec);
+    if (ec || size == 0) {
+      return;
+    }
+
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file.native_handle(), 0);
+    if (data == MAP_FAILED) {
+      ec.assign(errno, std::system_category());
+      return;
+    }
+
+    ::madvise(data, size, MADV_WILLNEED);
+    data_ = static_cast<const char*>(data);
+    size_ = size;
+  }
+
+  ~MappedFile() {
+    if (data_) {
+      ::munmap(const_cast<char*>(data_), size_);
+    }
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* data() const { return data_; }
+  std::size_t size() const { return size_; }
+
+private:
+  const char* data_{ nullptr };
+  std::size_t size_{ 0 };
+};
+
+class StringTable {
+public:
+  // Appends `value`, sharing storage with an identical earlier string
+  // when `intern` is set (mime types repeat on every record).
+  std::optional<StringRef> add(std::string_view value, bool intern = false) {
+    if (intern) {
+      auto it = interned_.find(value);
+      if (it != interned_.end()) {
+        return it->second;
+      }
+    }
+
+    if (blob_.size() + value.size() > std::numeric_limits<uint32_t>::max()) {
+      return std::nullopt;
+    }
+
+    StringRef ref{ static_cast<uint32_t>(blob_.size()), static_cast<uint32_t>(value.size()) };
+    blob_.append(value);
+    if (intern) {
+      interned_.emplace(std::string{ value }, ref);
+    }
+    return ref;
+  }
+
+  const std::string& blob() const { return blob_; }
+
+private:
+  std::string blob_;
+  std::map<std::string, StringRef, std::less<>> interned_;
+};
+
+bool write_all(int fd, const char* data, std::size_t size) {
+  while (size > 0) {
+    ssize_t written = ::write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    data += written;
+    size -= static_cast<std::size_t>(written);
+  }
+  return true;
+}
+
+} // namespace
+
+std::optional<std::vector<CatalogIndexEntry>> read_catalog_index(
+  const std::filesystem::path&  index_path,
+  const std::filesystem::path&  media_root
+) {
+  std::error_code ec;
+  MappedFile file(index_path, ec);
+  if (ec || file.size() < sizeof(FileHeader)) {
+    return std::nullopt;
+  }
+
+  FileHeader header;
+  std::memcpy(&header, file.data(), sizeof(header));
+
+  if (std::memcmp(header.magic, index_magic, sizeof(index_magic)) != 0
+      || header.byte_order != byte_order_mark) {
+    LOG_WARN("Ignoring catalog index ", index_path.string(), ": not an index file");
+    return std::nullopt;
+  }
+  if (header.version != catalog_index_version) {
+    LOG_INFO("Ignoring catalog index ", index_path.string(), ": version ", header.version);
+    return std::nullopt;
+  }
+
+  std::size_t payload_size{ file.size() - sizeof(FileHeader) };
+  if (header.entry_count > payload_size / sizeof(Record)
+      || header.entry_count * sizeof(Record) + header.strings_size != payload_size) {
+    LOG_WARN("Ignoring catalog index ", index_path.string(), ": truncated");
+    return std::nullopt;
+  }
+
+  const char* records{ file.data() + sizeof(FileHeader) };
+  const char* strings{ records + header.entry_count * sizeof(Record) };
+
+  if (fnv1a(records, payload_size) != header.checksum) {
+    LOG_WARN("Ignoring catalog index ", index_path.string(), ": checksum mismatch");
+    return std::nullopt;
+  }
+
+  auto in_bounds = [&header](StringRef ref) {
+    return uint64_t{ ref.offset } + ref.length <= header.strings_size;
+  };
+  auto view = [strings](StringRef ref) {
+    return std::string_view{ strings + ref.offset, ref.length };
+  };
+
+  StringRef root{ header.root_offset, header.root_length };
+  if (!in_bounds(root) || view(root) != media_root.native()) {
+    LOG_INFO("Ignoring catalog index ", index_path.string(), ": written for another media root");
+    return std::nullopt;
+  }
+
+  std::vector<CatalogIndexEntry> entries;
+  entries.reserve(header.entry_count);
+
+  for (uint64_t i{ 0 }; i < header.entry_count; ++i) {
+    Record record;
+    std::memcpy(&record, records + i * sizeof(Record), sizeof(Record));
+
+    if (!in_bounds(record.path) || !in_bounds(record.optimized_path) || !in_bounds(record.mime_type)) {
+      LOG_WARN("Ignoring catalog index ", index_path.string(), ": bad string reference");
+      return std::nullopt;
+    }
+    if (!valid_container(record.container)) {
+      LOG_WARN("Ignoring catalog index ", index_path.string(), ": bad container record");
+      return std::nullopt;
+    }
+
+    CatalogIndexEntry entry;
+    entry.file_path = view(record.path);
+    entry.optimized_path = view(record.optimized_path);
+    entry.mime_type = view(record.mime_type);
+    entry.inode = record.inode;
+    entry.file_size = record.file_size;
+    entry.modified_at = from_ns(record.modified_ns);
+    entry.created_at = from_ns(record.created_ns);
+    entry.container = record.container;
+    entries.push_back(std::move(entry));
+  }
+
+  return entries;
+}
+
+bool write_catalog_index(
+  const std::filesystem::path&  index_path,
+  const std::filesystem::path&  media_root,
+  const core::MediaList&        media
+) {
+  StringTable strings;
+  std::vector<Record> records;
+  records.reserve(media.size());
+
+  auto root = strings.add(media_root.native());
+  if (!root) {
+    return false;
+  }
+
+  for (const auto& info : media) {
+    auto path = strings.add(info.file_path);
+    auto optimized_path = strings.add(info.optimized_path);
+    auto mime_type = strings.add(core::to_string(info.mime_type), true);
+    if (!path || !optimized_path || !mime_type) {
+      LOG_WARN("Catalog index not written: string table over 4 GiB");
+      return false;
+    }
+
+    records.push_back(Record{
+      info.inode,
+      info.file_size,
+      to_ns(info.modified_at),
+      to_ns(info.created_at),
+      *path,
+      *optimized_path,
+      *mime_type,
+      info.container
+    });
+  }
+
+  const auto& blob = strings.blob();
+  const char* record_bytes{ reinterpret_cast<const char*>(records.data()) };
+  std::size_t records_size{ records.size() * sizeof(Record) };
+
+  FileHeader header{};
+  std::memcpy(header.magic, index_magic, sizeof(index_magic));
+  header.version = catalog_index_version;
+  header.byte_order = byte_order_mark;
+  header.entry_count = records.size();
+  header.strings_size = blob.size();
+  header.checksum = fnv1a(blob.data(), blob.size(), fnv1a(record_bytes, records_size));
+  header.root_offset = root->offset;
+  header.root_length = root->length;
+
+  std::error_code ec;
+  std::filesystem::create_directories(index_path.parent_path(), ec);
+
+  // Readers only ever see the old file or the complete new one.
+  auto temp_path = index_path;
+  temp_path += ".tmp";
+
+  int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    LOG_WARN("Catalog index not written: ", temp_path.string(), ": ", std::strerror(errno));
+    return false;
+  }
+
+  bool ok = write_all(fd, reinterpret_cast<const char*>(&header), sizeof(header))
+    && write_all(fd, record_bytes, records_size)
+    && write_all(fd, blob.data(), blob.size())
+    && ::fsync(fd) == 0;
+  int saved_errno = errno;
+  ::close(fd);
+
+  if (!ok || ::rename(temp_path.c_str(), index_path.c_str()) != 0) {
+    if (ok) {
+      saved_errno = errno;
+    }
+    LOG_WARN("Catalog index not written: ", index_path.string(), ": ", std::strerror(saved_errno));
+    ::unlink(temp_path.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+} // namespace venturi::adapters
@@ -0,0 +1,49 @@
+#pragma once
+#include "../../core/entities/MediaInfo.hpp"
+#include "../../core/entities/MediaList.hpp"
+
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace venturi::adapters {
+
+// On-disk snapshot of the catalog, so a restart can serve the last known
+// library at once and reconcile with the disk afterwards.
+//
+// The file is a fixed header, an array of fixed-size records and a blob of
+// the strings they reference, written in native byte order. It is read by
+// mapping it and decoding the records in one pass. Ids and ETags are not
+// stored; they are derived from path and stat fields, as a scan would.
+// Probe results are stored, so a restart does not re-read every file.
+//
+// Bump `catalog_index_version` whenever the layout or the meaning of a
+// field changes: files of any other version are ignored, never migrated.
+inline constexpr uint32_t catalog_index_version{ 2 };
+
+struct CatalogIndexEntry {
+  std::string file_path;
+  std::string optimized_path;
+  std::string mime_type;
+  uint64_t inode{ 0 };
+  uint64_t file_size{ 0 };
+  std::chrono::system_clock::time_point modified_at;
+  std::chrono::system_clock::time_point created_at;
+  core::ContainerInfo container;
+};
+
+// Entries of the index at `index_path`, or nullopt if it is missing,
+// corrupt, of another version, or was written for another media root.
+std::optional<std::vector<CatalogIndexEntry>> read_catalog_index(
+  const std::filesystem::path&  index_path,
+  const std::filesystem::path&  media_root
+);
+
+// Replaces the index at `index_path` atomically (write, fsync, rename).
+bool write_catalog_index(
+  const std::filesystem::path&  index_path,
+  const std::filesystem::path&  media_root,
+  const core::MediaList&        media
+);
+
+} // namespace venturi::adapters
@@ -0,0 +1,232 @@
+#include "CatalogSnapshot.hpp"
+#include "../../../app/Logger.hpp"
+
+namespace venturi::adapters {
+
+namespace {
+
+bool id_less(const core::MediaHandle& a, const core::MediaHandle& b) {
+  return a->id < b->id;
+}
+
+bool path_less(const core::MediaHandle& a, const core::MediaHandle& b) {
+  return a->file_path < b->file_path;
+}
+
+bool path_before(const core::MediaHandle& media, std::string_view key) {
+  return media->file_path < key;
+}
+
+// Rescanning an unchanged file must not make a new version.
+bool same_media(const core::MediaInfo& a, const core::MediaInfo& b) {
+  return a.file_path == b.file_path
+    && a.optimized_path == b.optimized_path
+    && a.mime_type == b.mime_type
+    && a.modified_at == b.modified_at
+    && a.inode == b.inode
+    && a.file_size == b.file_size
+    && a.container == b.container;
+}
+
+// Two files whose paths hash to the same id. The path that sorts first
+// keeps the id, so the outcome does not depend on scan order; the other
+// file stays out of the catalog.
+bool prefer_over(const core::MediaInfo& candidate, const core::MediaInfo& current) {
+  LOG_ERROR("Media id collision: ", candidate.id.to_string(), " is both ",
+            current.file_path, " and ", candidate.file_path);
+  return candidate.file_path < current.file_path;
+}
+
+// Sorts by id and keeps one entry per id: the last one for the same file,
+// the collision winner for different files.
+void sort_unique_by_id(CatalogSnapshot::Handles& media) {
+  std::stable_sort(media.begin(), media.end(), id_less);
+
+  std::size_t out{ 0 };
+  for (std::size_t i{ 0 }; i < media.size(); ++i) {
+    if (out > 0 && media[out - 1]->id == media[i]->id) {
+      if (media[out - 1]->file_path == media[i]->file_path || prefer_over(*media[i], *media[out - 1])) {
+        media[out - 1] = std::move(media[i]);
+      }
+      continue;
+    }
+    media[out++] = std::move(media[i]);
+  }
+  media.resize(out);
+}
+
+} // namespace
+
+std::shared_ptr<const CatalogSnapshot> CatalogSnapshot::build(Handles media, uint64_t generation) {
+  auto snapshot = std::make_shared<CatalogSnapshot>();
+  snapshot->generation_ = generation;
+
+  Handles by_id = media;
+  sort_unique_by_id(by_id);
+  if (by_id.size() != media.size()) {
+    media = by_id;
+  }
+
+  snapshot->by_id_.reserve(by_id.size());
+  for (auto& handle : by_id) {
+    auto id = handle->id;
+    snapshot->by_id_.push_back({ id, std::move(handle) });
+  }
+
+  if (!std::is_sorted(media.begin(), media.end(), path_less)) {
+    std::sort(media.begin(), media.end(), path_less);
+  }
+  snapshot->by_path_ = std::move(media);
+
+  return snapshot;
+}
+
+core::MediaHandle CatalogSnapshot::find_by_id(core::MediaId id) const {
+  auto it = std::lower_bound(by_id_.begin(), by_id_.end(), id,
+    [](const IdSlot& slot, core::MediaId key) { return slot.id < key; });
+
+  if (it == by_id_.end() || it->id != id) {
+    return nullptr;
+  }
+  return it->media;
+}
+
+core::MediaHandle CatalogSnapshot::find_by_path(const std::filesystem::path& path) const {
+  auto it = std::lower_bound(by_path_.begin(), by_path_.end(), path.native(), path_before);
+
+  if (it == by_path_.end() || (*it)->file_path != path.native()) {
+    return nullptr;
+  }
+  return *it;
+}
+
+std::span<const core::MediaHandle> CatalogSnapshot::after(const std::filesystem::path& after) const {
+  if (after.empty()) {
+    return by_path_;
+  }
+
+  auto it = std::upper_bound(by_path_.begin(), by_path_.end(), after.native(),
+    [](std::string_view key, const core::MediaHandle& media) { return key < media->file_path; });
+  return { it, by_path_.end() };
+}
+
+std::span<const core::MediaHandle> CatalogSnapshot::under(const std::filesystem::path& directory) const {
+  // Strings sharing a prefix sort together, so a subtree is one run.
+  std::string prefix{ directory.native() };
+  if (!prefix.ends_with('/')) {
+    prefix += '/';
+  }
+
+  auto first = std::lower_bound(by_path_.begin(), by_path_.end(), prefix, path_before);
+  auto last = std::partition_point(first, by_path_.end(),
+    [&prefix](const core::MediaHandle& media) { return media->file_path.starts_with(prefix); });
+  return { first, last };
+}
+
+std::shared_ptr<const CatalogSnapshot> CatalogSnapshot::with_changes(
+  Handles                     upserts,
+  std::vector<core::MediaId>  removals
+) const {
+  sort_unique_by_id(upserts);
+  std::sort(removals.begin(), removals.end());
+
+  // Merge by id, collecting what enters and leaves the catalog.
+  std::vector<IdSlot> next_by_id;
+  next_by_id.reserve(by_id_.size() + upserts.size());
+  Handles added;
+  Handles dropped;
+
+  auto upsert = upserts.begin();
+  auto removal = removals.begin();
+
+  auto add = [&next_by_id, &added](core::MediaHandle media) {
+    added.push_back(media);
+    auto id = media->id;
+    next_by_id.push_back({ id, std::move(media) });
+  };
+
+  for (const auto& current : by_id_) {
+    for (; upsert != upserts.end() && (*upsert)->id < current.id; ++upsert) {
+      add(std::move(*upsert));
+    }
+    while (removal != removals.end() && *removal < current.id) {
+      ++removal;
+    }
+
+    if (upsert != upserts.end() && (*upsert)->id == current.id) {
+      const auto& media = *current.media;
+      if (same_media(**upsert, media)
+          || (media.file_path != (*upsert)->file_path && !prefer_over(**upsert, media))) {
+        next_by_id.push_back(current);
+      } else {
+        dropped.push_back(current.media);
+        add(std::move(*upsert));
+      }
+      ++upsert;
+    } else if (removal != removals.end() && *removal == current.id) {
+      dropped.push_back(current.media);
+    } else {
+      next_by_id.push_back(current);
+    }
+  }
+  for (; upsert != upserts.end(); ++upsert) {
+    add(std::move(*upsert));
+  }
+
+  if (added.empty() && dropped.empty()) {
+    return nullptr;
+  }
+
+  // Locate the changes in path order by binary search, then splice them in
+  // with a single pass that compares positions rather than paths.
+  auto position = [this](std::string_view path) {
+    return static_cast<std::size_t>(std::lower_bound(by_path_.begin(), by_path_.end(), path, path_before)
+      - by_path_.begin());
+  };
+
+  std::vector<std::size_t> drop_at;
+  drop_at.reserve(dropped.size());
+  for (const auto& media : dropped) {
+    // The exact handle, should a caller have saved two ids under one path.
+    auto i = position(media->file_path);
+    while (i + 1 < by_path_.size() && by_path_[i] != media && by_path_[i + 1]->file_path == media->file_path) {
+      ++i;
+    }
+    drop_at.push_back(i);
+  }
+  std::sort(drop_at.begin(), drop_at.end());
+
+  std::sort(added.begin(), added.end(), path_less);
+  std::vector<std::size_t> insert_at;
+  insert_at.reserve(added.size());
+  for (const auto& media : added) {
+    insert_at.push_back(position(media->file_path));
+  }
+
+  Handles next_by_path;
+  next_by_path.reserve(by_path_.size() - dropped.size() + added.size());
+
+  std::size_t a{ 0 };
+  std::size_t d{ 0 };
+  for (std::size_t i{ 0 }; i < by_path_.size(); ++i) {
+    for (; a < added.size() && insert_at[a] == i; ++a) {
+      next_by_path.push_back(std::move(added[a]));
+    }
+    if (d < drop_at.size() && drop_at[d] == i) {
+      ++d;
+      continue;
+    }
+    next_by_path.push_back(by_path_[i]);
+  }
+  for (; a < added.size(); ++a) {
+    next_by_path.push_back(std::move(added[a]));
+  }
+
+  auto next = std::make_shared<CatalogSnapshot>();
+  next->generation_ = generation_ + 1;
+  next->by_path_ = std::move(next_by_path);
+  next->by_id_ = std::move(next_by_id);
+  return next;
+}
+
+} // namespace venturi::adapters
@@ -0,0 +1,73 @@
+#pragma once
+#include "../../core/entities/MediaInfo.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace venturi::adapters {
+
+// Whether `path` is `directory` itself or lies somewhere below it.
+inline bool is_under(const std::filesystem::path& path, const std::filesystem::path& directory) {
+  auto dir_end = std::mismatch(directory.begin(), directory.end(), path.begin(), path.end()).first;
+  return dir_end == directory.end() || (std::next(dir_end) == directory.end() && dir_end->empty());
+}
+
+// One immutable version of the catalog.
+//
+// Entries are shared MediaInfo handles kept in path order for listings,
+// plus a flat array of (id, handle) slots in id order, so a lookup binary
+// searches plain integers and touches one entry. A snapshot never changes
+// once built:
+// readers use the version they loaded for as long as they hold it, and
+// writers derive the next one with with_changes(). That copies the handle
+// vectors but compares only the entries being added or dropped, so a batch
+// of k changes to n entries costs O(n) pointer copies plus O(k log n)
+// comparisons.
+class CatalogSnapshot {
+public:
+  using Handles = std::vector<core::MediaHandle>;
+
+  CatalogSnapshot() = default;
+
+  // From entries in any order (path order is cheapest). Of entries sharing
+  // an id, the last wins; if their paths differ, the one sorting first.
+  static std::shared_ptr<const CatalogSnapshot> build(Handles media, uint64_t generation);
+
+  uint64_t generation() const { return generation_; }
+  std::size_t size() const { return by_path_.size(); }
+  bool empty() const { return by_path_.empty(); }
+
+  core::MediaHandle find_by_id(core::MediaId id) const;
+  core::MediaHandle find_by_path(const std::filesystem::path& path) const;
+
+  // Entries in path order: all of them, those sorting strictly after
+  // `after`, or those below `directory`.
+  std::span<const core::MediaHandle> entries() const { return by_path_; }
+  std::span<const core::MediaHandle> after(const std::filesystem::path& after) const;
+  std::span<const core::MediaHandle> under(const std::filesystem::path& directory) const;
+
+  // The next version: `upserts` added, or replacing the entry with the same
+  // id, and entries whose id is in `removals` dropped. An upsert identical
+  // to the entry it replaces is not a change, nor is one losing an id
+  // collision. Returns null if nothing changed, so callers can skip
+  // publishing.
+  std::shared_ptr<const CatalogSnapshot> with_changes(
+    Handles                     upserts,
+    std::vector<core::MediaId>  removals
+  ) const;
+
+private:
+  struct IdSlot {
+    core::MediaId id;
+    core::MediaHandle media;
+  };
+
+  uint64_t generation_{ 0 };
+  Handles by_path_;
+  std::vector<IdSlot> by_id_;
+};
+
+} // namespace venturi::adapters
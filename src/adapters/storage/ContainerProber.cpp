@@ -0,0 +1,573 @@
+#include "ContainerProber.hpp"
+
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <optional>
+
+namespace venturi::adapters {
+
+namespace {
+
+using Track = core::ContainerInfo::Track;
+
+constexpr std::size_t window_size{ 16 * 1024 };
+
+// Children visited per parent, so a corrupt file cannot keep a probe busy.
+constexpr int max_children{ 256 };
+
+// The file as seen through one window; every move of the window is a read.
+class ProbeReader {
+public:
+  ProbeReader(int fd, uint64_t file_size) : fd_(fd), file_size_(file_size) {}
+
+  uint64_t file_size() const { return file_size_; }
+
+  // `length` bytes at `offset`, read in unless already in the window; null
+  // past the end of the file or once the read budget is spent.
+  const unsigned char* at(uint64_t offset, std::size_t length) {
+    if (length > window_size || offset > file_size_ || length > file_size_ - offset) {
+      return nullptr;
+    }
+
+    if (offset < window_offset_ || offset + length > window_offset_ + window_length_) {
+      if (reads_ == probe_max_reads) {
+        return nullptr;
+      }
+      ++reads_;
+
+      std::size_t wanted{ static_cast<std::size_t>(std::min<uint64_t>(window_size, file_size_ - offset)) };
+      std::size_t got{ 0 };
+      while (got < wanted) {
+        ssize_t bytes = ::pread(fd_, buffer_.data() + got, wanted - got, static_cast<off_t>(offset + got));
+        if (bytes < 0 && errno == EINTR) continue;
+        if (bytes <= 0) break;
+        got += static_cast<std::size_t>(bytes);
+      }
+
+      window_offset_ = offset;
+      window_length_ = got;
+      if (length > got) {
+        return nullptr;
+      }
+    }
+
+    return buffer_.data() + (offset - window_offset_);
+  }
+
+private:
+  int fd_;
+  uint64_t file_size_;
+  std::array<unsigned char, window_size> buffer_;
+  uint64_t window_offset_{ 0 };
+  std::size_t window_length_{ 0 };
+  int reads_{ 0 };
+};
+
+uint64_t read_be(const unsigned char* p, std::size_t bytes) {
+  uint64_t value{ 0 };
+  for (std::size_t i{ 0 }; i < bytes; ++i) {
+    value = (value << 8) | p[i];
+  }
+  return value;
+}
+
+uint32_t be32(const unsigned char* p) {
+  return static_cast<uint32_t>(read_be(p, 4));
+}
+
+uint64_t be64(const unsigned char* p) {
+  return read_be(p, 8);
+}
+
+void set_codec(Track& track, const unsigned char* name, std::size_t length) {
+  std::memcpy(track.codec.data(), name, std::min(length, track.codec.size()));
+}
+
+uint32_t to_milliseconds(uint64_t duration, uint64_t units_per_second) {
+  if (units_per_second == 0) {
+    return 0;
+  }
+  uint64_t ms{ duration / units_per_second * 1000 + duration % units_per_second * 1000 / units_per_second };
+  return static_cast<uint32_t>(std::min<uint64_t>(ms, std::numeric_limits<uint32_t>::max()));
+}
+
+// --- MP4 (ISO/IEC 14496-12) ---
+
+constexpr uint32_t fourcc(const char (&name)[5]) {
+  return static_cast<uint32_t>(name[0]) << 24 | static_cast<uint32_t>(name[1]) << 16
+    | static_cast<uint32_t>(name[2]) << 8 | static_cast<uint32_t>(name[3]);
+}
+
+struct Box {
+  uint32_t type;
+  uint64_t offset;
+  uint64_t payload;
+  uint64_t end;
+};
+
+std::optional<Box> read_box(ProbeReader& reader, uint64_t offset, uint64_t limit) {
+  if (offset > limit || limit - offset < 8) {
+    return std::nullopt;
+  }
+
+  const unsigned char* p{ reader.at(offset, 8) };
+  if (!p) {
+    return std::nullopt;
+  }
+
+  uint64_t size{ be32(p) };
+  uint32_t type{ be32(p + 4) };
+  uint64_t header{ 8 };
+
+  if (size == 1) {
+    if (limit - offset < 16 || !(p = reader.at(offset, 16))) {
+      return std::nullopt;
+    }
+    size = be64(p + 8);
+    header = 16;
+  } else if (size == 0) {
+    size = limit - offset;   // runs to the end of the file
+  }
+
+  if (size < header || size > limit - offset) {
+    return std::nullopt;
+  }
+  return Box{ type, offset, offset + header, offset + size };
+}
+
+// Calls `visit` with each child box until it returns false.
+template <typename Visit>
+void for_each_box(ProbeReader& reader, uint64_t begin, uint64_t end, Visit&& visit) {
+  uint64_t offset{ begin };
+  for (int i{ 0 }; i < max_children && offset < end; ++i) {
+    auto box = read_box(reader, offset, end);
+    if (!box || !visit(*box)) {
+      return;
+    }
+    offset = box->end;
+  }
+}
+
+std::optional<Box> find_box(ProbeReader& reader, const std::optional<Box>& parent, uint32_t type) {
+  std::optional<Box> found;
+  if (parent) {
+    for_each_box(reader, parent->payload, parent->end, [&found, type](const Box& box) {
+      if (box.type == type) {
+        found = box;
+      }
+      return !found;
+    });
+  }
+  return found;
+}
+
+Track::Kind handler_kind(uint32_t handler) {
+  switch (handler) {
+    case fourcc("vide"): return Track::Kind::video;
+    case fourcc("soun"): return Track::Kind::audio;
+    case fourcc("sbtl"):
+    case fourcc("subt"):
+    case fourcc("text"):
+    case fourcc("clcp"): return Track::Kind::subtitle;
+    default:             return Track::Kind::other;
+  }
+}
+
+void parse_trak(ProbeReader& reader, const Box& trak, core::ContainerInfo& info) {
+  if (info.track_count == core::ContainerInfo::max_tracks) {
+    return;
+  }
+
+  auto mdia = find_box(reader, trak, fourcc("mdia"));
+  if (!mdia) {
+    return;
+  }
+
+  Track track;
+  if (auto hdlr = find_box(reader, mdia, fourcc("hdlr"))) {
+    if (const unsigned char* p = reader.at(hdlr->payload, 12)) {
+      track.kind = handler_kind(be32(p + 8));
+    }
+  }
+
+  // The first sample entry names the codec.
+  auto stbl = find_box(reader, find_box(reader, mdia, fourcc("minf")), fourcc("stbl"));
+  if (auto stsd = find_box(reader, stbl, fourcc("stsd"))) {
+    const unsigned char* p{ reader.at(stsd->payload, 16) };
+    if (p && be32(p + 4) > 0) {
+      set_codec(track, p + 12, 4);
+    }
+  }
+
+  info.tracks[info.track_count++] = track;
+}
+
+void parse_moov(ProbeReader& reader, const Box& moov, core::ContainerInfo& info) {
+  uint64_t timescale{ 0 };
+  uint64_t duration{ 0 };
+  uint64_t fragment_duration{ 0 };
+
+  for_each_box(reader, moov.payload, moov.end, [&](const Box& box) {
+    if (box.type == fourcc("mvhd")) {
+      if (const unsigned char* p = reader.at(box.payload, 32)) {
+        if (p[0] == 1) {
+          timescale = be32(p + 20);
+          duration = be64(p + 24);
+        } else {
+          timescale = be32(p + 12);
+          duration = be32(p + 16);
+          if (duration == std::numeric_limits<uint32_t>::max()) {
+            duration = 0;   // unknown
+          }
+        }
+      }
+    } else if (box.type == fourcc("trak")) {
+      parse_trak(reader, box, info);
+    } else if (box.type == fourcc("mvex")) {
+      // Fragmented files often leave mvhd at zero and give the total here.
+      if (auto mehd = find_box(reader, box, fourcc("mehd"))) {
+        if (const unsigned char* p = reader.at(mehd->payload, 12)) {
+          fragment_duration = p[0] == 1 ? be64(p + 4) : be32(p + 4);
+        }
+      }
+    }
+    return true;
+  });
+
+  info.duration_ms = to_milliseconds(duration != 0 ? duration : fragment_duration, timescale);
+}
+
+bool is_mp4(const unsigned char* p) {
+  switch (be32(p + 4)) {
+    case fourcc("ftyp"):
+    // Older QuickTime files start straight with one of these.
+    case fourcc("moov"):
+    case fourcc("mdat"):
+    case fourcc("wide"):
+    case fourcc("free"):
+    case fourcc("skip"):
+      return true;
+    default:
+      return false;
+  }
+}
+
+void probe_mp4(ProbeReader& reader, core::ContainerInfo& info) {
+  info.format = core::ContainerInfo::Format::mp4;
+
+  for_each_box(reader, 0, reader.file_size(), [&](const Box& box) {
+    switch (box.type) {
+      case fourcc("moov"):
+        info.index_offset = box.offset;
+        info.index_size = box.end - box.offset;
+        parse_moov(reader, box, info);
+        break;
+      case fourcc("moof"):
+        info.fragmented = true;
+        [[fallthrough]];
+      case fourcc("mdat"):
+        if (info.media_offset == 0) {
+          info.media_offset = box.offset;
+        }
+        break;
+    }
+    return info.index_offset == 0 || info.media_offset == 0;
+  });
+}
+
+// --- Matroska / WebM (EBML) ---
+
+constexpr uint32_t ebml_id{ 0x1A45DFA3 };
+constexpr uint32_t segment_id{ 0x18538067 };
+constexpr uint32_t seek_head_id{ 0x114D9B74 };
+constexpr uint32_t seek_id{ 0x4DBB };
+constexpr uint32_t seek_id_id{ 0x53AB };
+constexpr uint32_t seek_position_id{ 0x53AC };
+constexpr uint32_t info_id{ 0x1549A966 };
+constexpr uint32_t timestamp_scale_id{ 0x2AD7B1 };
+constexpr uint32_t duration_id{ 0x4489 };
+constexpr uint32_t tracks_id{ 0x1654AE6B };
+constexpr uint32_t track_entry_id{ 0xAE };
+constexpr uint32_t track_type_id{ 0x83 };
+constexpr uint32_t codec_id_id{ 0x86 };
+constexpr uint32_t cues_id{ 0x1C53BB6B };
+constexpr uint32_t cluster_id{ 0x1F43B675 };
+
+struct Element {
+  uint32_t id;
+  uint64_t offset;
+  uint64_t data;
+  uint64_t end;
+  bool unknown_size;
+};
+
+std::optional<Element> read_element(ProbeReader& reader, uint64_t offset, uint64_t limit) {
+  if (offset >= limit) {
+    return std::nullopt;
+  }
+
+  // At most a 4-byte id and an 8-byte size.
+  std::size_t available{ static_cast<std::size_t>(std::min<uint64_t>(12, limit - offset)) };
+  const unsigned char* p{ reader.at(offset, available) };
+  if (!p || p[0] == 0) {
+    return std::nullopt;
+  }
+
+  // Ids keep their length marker bits.
+  std::size_t id_length{ static_cast<std::size_t>(std::countl_zero(p[0])) + 1 };
+  if (id_length > 4 || id_length >= available || p[id_length] == 0) {
+    return std::nullopt;
+  }
+  uint32_t id{ static_cast<uint32_t>(read_be(p, id_length)) };
+
+  // Sizes drop theirs; all value bits set means "unknown".
+  const unsigned char* size_bytes{ p + id_length };
+  std::size_t size_length{ static_cast<std::size_t>(std::countl_zero(size_bytes[0])) + 1 };
+  if (size_length > available - id_length) {
+    return std::nullopt;
+  }
+  uint64_t marker_mask{ 0xFFu >> size_length };
+  uint64_t size{ size_bytes[0] & marker_mask };
+  bool unknown{ size == marker_mask };
+  for (std::size_t i{ 1 }; i < size_length; ++i) {
+    size = (size << 8) | size_bytes[i];
+    unknown &= size_bytes[i] == 0xFF;
+  }
+
+  uint64_t data{ offset + id_length + size_length };
+  if (data > limit || (!unknown && size > limit - data)) {
+    return std::nullopt;
+  }
+  return Element{ id, offset, data, unknown ? limit : data + size, unknown };
+}
+
+// Calls `visit` with each child element until it returns false. An
+// element of unknown size cannot be skipped, so it is always the last.
+template <typename Visit>
+void for_each_element(ProbeReader& reader, const Element& parent, Visit&& visit) {
+  uint64_t offset{ parent.data };
+  for (int i{ 0 }; i < max_children && offset < parent.end; ++i) {
+    auto element = read_element(reader, offset, parent.end);
+    if (!element || !visit(*element) || element->unknown_size) {
+      return;
+    }
+    offset = element->end;
+  }
+}
+
+std::optional<uint64_t> read_uint(ProbeReader& reader, const Element& element) {
+  uint64_t size{ element.end - element.data };
+  if (size > 8) {
+    return std::nullopt;
+  }
+  const unsigned char* p{ reader.at(element.data, size) };
+  return p ? std::optional{ read_be(p, size) } : std::nullopt;
+}
+
+void parse_info(ProbeReader& reader, const Element& info_element, core::ContainerInfo& info) {
+  uint64_t scale{ 1'000'000 };   // nanoseconds per tick, the default
+  double duration{ 0.0 };
+
+  for_each_element(reader, info_element, [&](const Element& element) {
+    if (element.id == timestamp_scale_id) {
+      scale = read_uint(reader, element).value_or(scale);
+    } else if (element.id == duration_id) {
+      uint64_t size{ element.end - element.data };
+      const unsigned char* p{ reader.at(element.data, size) };
+      if (p && size == 4) {
+        duration = std::bit_cast<float>(be32(p));
+      } else if (p && size == 8) {
+        duration = std::bit_cast<double>(be64(p));
+      }
+    }
+    return true;
+  });
+
+  double ms{ duration * static_cast<double>(scale) / 1e6 };
+  if (ms > 0.0 && ms < std::numeric_limits<uint32_t>::max()) {
+    info.duration_ms = static_cast<uint32_t>(ms);
+  }
+}
+
+void parse_tracks(ProbeReader& reader, const Element& tracks, core::ContainerInfo& info) {
+  for_each_element(reader, tracks, [&](const Element& entry) {
+    if (info.track_count == core::ContainerInfo::max_tracks) {
+      return false;
+    }
+    if (entry.id != track_entry_id) {
+      return true;
+    }
+
+    Track track;
+    for_each_element(reader, entry, [&](const Element& element) {
+      if (element.id == track_type_id) {
+        switch (read_uint(reader, element).value_or(0)) {
+          case 1:    track.kind = Track::Kind::video; break;
+          case 2:    track.kind = Track::Kind::audio; break;
+          case 0x11: track.kind = Track::Kind::subtitle; break;
+        }
+      } else if (element.id == codec_id_id) {
+        std::size_t length{ static_cast<std::size_t>(std::min<uint64_t>(element.end - element.data, track.codec.size())) };
+        if (const unsigned char* p = reader.at(element.data, length)) {
+          set_codec(track, p, length);
+        }
+      }
+      return true;
+    });
+
+    info.tracks[info.track_count++] = track;
+    return info.track_count < core::ContainerInfo::max_tracks;
+  });
+}
+
+// Offsets the SeekHead gives for the top-level elements we may need.
+struct SeekTargets {
+  uint64_t info{ 0 };
+  uint64_t tracks{ 0 };
+  uint64_t cues{ 0 };
+};
+
+void parse_seek_head(
+  ProbeReader&    reader,
+  const Element&  seek_head,
+  uint64_t        segment_data,
+  SeekTargets&    targets
+) {
+  for_each_element(reader, seek_head, [&](const Element& seek) {
+    if (seek.id != seek_id) {
+      return true;
+    }
+
+    uint64_t target_id{ 0 };
+    std::optional<uint64_t> position;
+    for_each_element(reader, seek, [&](const Element& element) {
+      if (element.id == seek_id_id) {
+        target_id = read_uint(reader, element).value_or(0);
+      } else if (element.id == seek_position_id) {
+        position = read_uint(reader, element);
+      }
+      return true;
+    });
+
+    if (position) {
+      uint64_t offset{ segment_data + *position };
+      switch (target_id) {
+        case info_id:   targets.info = offset; break;
+        case tracks_id: targets.tracks = offset; break;
+        case cues_id:   targets.cues = offset; break;
+      }
+    }
+    return true;
+  });
+}
+
+void probe_matroska(ProbeReader& reader, core::ContainerInfo& info) {
+  auto header = read_element(reader, 0, reader.file_size());
+  if (!header || header->id != ebml_id || header->unknown_size) {
+    return;
+  }
+  auto segment = read_element(reader, header->end, reader.file_size());
+  if (!segment || segment->id != segment_id) {
+    return;
+  }
+
+  info.format = core::ContainerInfo::Format::matroska;
+
+  SeekTargets targets;
+  bool have_info{ false };
+  bool have_tracks{ false };
+
+  auto set_index = [&info](const Element& cues) {
+    info.index_offset = cues.offset;
+    info.index_size = cues.end - cues.offset;
+  };
+
+  // Everything of interest normally precedes the first Cluster.
+  for_each_element(reader, *segment, [&](const Element& element) {
+    switch (element.id) {
+      case seek_head_id:
+        parse_seek_head(reader, element, segment->data, targets);
+        break;
+      case info_id:
+        parse_info(reader, element, info);
+        have_info = true;
+        break;
+      case tracks_id:
+        // A second Tracks element would only list the same tracks again.
+        if (!have_tracks) {
+          parse_tracks(reader, element, info);
+          have_tracks = true;
+        }
+        break;
+      case cues_id:
+        set_index(element);
+        break;
+      case cluster_id:
+        info.media_offset = element.offset;
+        return false;
+    }
+    return true;
+  });
+
+  // Whatever sits after the clusters (usually the Cues) is reached
+  // through the SeekHead instead of walking every cluster.
+  auto seek = [&](uint64_t offset, uint32_t id) -> std::optional<Element> {
+    if (offset == 0) {
+      return std::nullopt;
+    }
+    auto element = read_element(reader, offset, segment->end);
+    return element && element->id == id ? element : std::nullopt;
+  };
+
+  if (!have_info) {
+    if (auto element = seek(targets.info, info_id)) parse_info(reader, *element, info);
+  }
+  if (!have_tracks) {
+    if (auto element = seek(targets.tracks, tracks_id)) parse_tracks(reader, *element, info);
+  }
+  if (info.index_offset == 0) {
+    if (auto element = seek(targets.cues, cues_id)) set_index(*element);
+  }
+}
+
+} // namespace
+
+core::ContainerInfo probe_container(const FileHandle& file, uint64_t file_size) {
+  core::ContainerInfo info;
+  ProbeReader reader(file.native_handle(), file_size);
+
+  const unsigned char* magic{ reader.at(0, 8) };
+  if (!magic) {
+    return info;
+  }
+
+  if (be32(magic) == ebml_id) {
+    probe_matroska(reader, info);
+  } else if (is_mp4(magic)) {
+    probe_mp4(reader, info);
+  }
+
+  if (info.index_offset != 0 || info.media_offset != 0) {
+    info.faststart = info.index_offset != 0 && info.index_offset < info.media_offset;
+  }
+  if (info.duration_ms > 0) {
+    info.bitrate = file_size * 8 * 1000 / info.duration_ms;
+  }
+  return info;
+}
+
+core::ContainerInfo probe_container(const std::string& path, uint64_t file_size) {
+  std::error_code ec;
+  auto file = FileHandle::open_read(path, ec);
+  if (ec) {
+    return {};
+  }
+  return probe_container(file, file_size);
+}
+
+} // namespace venturi::adapters
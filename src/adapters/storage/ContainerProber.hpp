@@ -0,0 +1,26 @@
+#pragma once
+#include "../../core/entities/ContainerInfo.hpp"
+#include "FileHandle.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace venturi::adapters {
+
+// Reads just enough of an MP4 (ISO BMFF) or Matroska/WebM file to fill in
+// a ContainerInfo: duration, bitrate, track codecs, whether it is
+// faststart, and where its index and media data lie.
+//
+// Box and element headers are read through one 16 KiB window, and only
+// the few small leaves that matter are decoded; sample tables, clusters
+// and everything else are skipped by size. A probe makes at most
+// `probe_max_reads` reads and allocates nothing, and gives up quietly on
+// truncated or malformed files, leaving whatever it found so far.
+inline constexpr int probe_max_reads{ 12 };
+
+core::ContainerInfo probe_container(const FileHandle& file, uint64_t file_size);
+
+// Opens `path` first; an unreadable file probes as unknown.
+core::ContainerInfo probe_container(const std::string& path, uint64_t file_size);
+
+} // namespace venturi::adapters
@@ -0,0 +1,499 @@
+#include "FaststartOptimizer.hpp"
+#include "ContainerProber.hpp"
+#include "../../../app/Logger.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace venturi::adapters {
+
+namespace {
+
+// Top-level boxes looked at before giving up on a file.
+constexpr std::size_t max_top_level_boxes{ 1024 };
+
+// The moov is patched in memory; larger ones are left alone.
+constexpr uint64_t max_moov_bytes{ 64ull * 1024 * 1024 };
+
+constexpr std::size_t copy_buffer_size{ 1024 * 1024 };
+constexpr std::size_t direct_io_alignment{ 4096 };
+
+// Written data is flushed and dropped from the page cache this often.
+constexpr uint64_t flush_interval{ 16ull * 1024 * 1024 };
+
+uint64_t read_be(const unsigned char* p, std::size_t bytes) {
+  uint64_t value{ 0 };
+  for (std::size_t i{ 0 }; i < bytes; ++i) {
+    value = (value << 8) | p[i];
+  }
+  return value;
+}
+
+void write_be(unsigned char* p, uint64_t value, std::size_t bytes) {
+  for (std::size_t i{ bytes }; i > 0; --i) {
+    p[i - 1] = static_cast<unsigned char>(value);
+    value >>= 8;
+  }
+}
+
+constexpr uint32_t fourcc(const char (&name)[5]) {
+  return static_cast<uint32_t>(name[0]) << 24 | static_cast<uint32_t>(name[1]) << 16
+    | static_cast<uint32_t>(name[2]) << 8 | static_cast<uint32_t>(name[3]);
+}
+
+struct TopLevelBox {
+  uint32_t type;
+  uint64_t offset;
+  uint64_t size;
+  std::size_t header;
+  bool to_end;   // size field 0: runs to the end of the file
+};
+
+std::optional<std::vector<TopLevelBox>> read_top_level(const FileHandle& file, uint64_t file_size) {
+  std::vector<TopLevelBox> boxes;
+  uint64_t offset{ 0 };
+
+  while (offset < file_size) {
+    std::size_t available{ static_cast<std::size_t>(std::min<uint64_t>(16, file_size - offset)) };
+    unsigned char header[16];
+    if (boxes.size() == max_top_level_boxes || available < 8 || !file.read_exact(header, available, offset)) {
+      return std::nullopt;
+    }
+
+    TopLevelBox box{ static_cast<uint32_t>(read_be(header + 4, 4)), offset, read_be(header, 4), 8, false };
+    if (box.size == 1) {
+      if (available < 16) return std::nullopt;
+      box.size = read_be(header + 8, 8);
+      box.header = 16;
+    } else if (box.size == 0) {
+      box.size = file_size - offset;
+      box.to_end = true;
+    }
+
+    if (box.size < box.header || box.size > file_size - offset) {
+      return std::nullopt;
+    }
+    boxes.push_back(box);
+    offset += box.size;
+  }
+
+  return boxes;
+}
+
+// Chunk offsets in [from, to) move up by `by`: the boxes between the
+// first mdat and the moov's old place.
+struct Shift {
+  uint64_t from;
+  uint64_t to;
+  uint64_t by;
+
+  uint64_t operator()(uint64_t offset) const {
+    return offset >= from && offset < to ? offset + by : offset;
+  }
+};
+
+// Shifts every stco/co64 entry below `parent`. False if the moov holds
+// something that cannot be moved this way.
+bool shift_chunk_offsets(std::span<unsigned char> parent, const Shift& shift) {
+  while (parent.size() >= 8) {
+    uint64_t size{ read_be(parent.data(), 4) };
+    uint32_t type{ static_cast<uint32_t>(read_be(parent.data() + 4, 4)) };
+    std::size_t header{ 8 };
+    if (size == 1) {
+      if (parent.size() < 16) return false;
+      size = read_be(parent.data() + 8, 8);
+      header = 16;
+    } else if (size == 0) {
+      size = parent.size();
+    }
+    if (size < header || size > parent.size()) {
+      return false;
+    }
+
+    auto payload{ parent.subspan(header, size - header) };
+    switch (type) {
+      case fourcc("trak"):
+      case fourcc("mdia"):
+      case fourcc("minf"):
+      case fourcc("stbl"):
+        if (!shift_chunk_offsets(payload, shift)) return false;
+        break;
+
+      // A compressed moov cannot be patched in place, and sample
+      // auxiliary info offsets are absolute too.
+      case fourcc("cmov"):
+      case fourcc("saio"):
+        return false;
+
+      case fourcc("stco"):
+      case fourcc("co64"): {
+        std::size_t entry_size{ type == fourcc("co64") ? 8u : 4u };
+        if (payload.size() < 8) return false;
+        uint64_t count{ read_be(payload.data() + 4, 4) };
+        if ((payload.size() - 8) / entry_size < count) return false;
+
+        for (uint64_t i{ 0 }; i < count; ++i) {
+          unsigned char* entry{ payload.data() + 8 + i * entry_size };
+          uint64_t offset{ shift(read_be(entry, entry_size)) };
+          if (entry_size == 4 && offset > std::numeric_limits<uint32_t>::max()) {
+            return false;   // would need co64, which changes the moov size
+          }
+          write_be(entry, offset, entry_size);
+        }
+        break;
+      }
+    }
+
+    parent = parent.subspan(size);
+  }
+  return true;
+}
+
+// Writes the copy sequentially, pacing itself to the configured rate and
+// keeping the amount of dirty page cache it leaves behind bounded.
+class CopyWriter {
+public:
+  CopyWriter(int fd, uint64_t max_bytes_per_second, std::stop_token stop)
+    : fd_(fd)
+    , rate_(max_bytes_per_second)
+    , stop_(std::move(stop))
+    , started_(std::chrono::steady_clock::now())
+    , buffer_(static_cast<char*>(std::aligned_alloc(direct_io_alignment, copy_buffer_size)))
+  {}
+
+  ~CopyWriter() { std::free(buffer_); }
+
+  CopyWriter(const CopyWriter&) = delete;
+  CopyWriter& operator=(const CopyWriter&) = delete;
+
+  bool write(const void* data, std::size_t length) {
+    const auto* bytes{ static_cast<const char*>(data) };
+    while (length > 0) {
+      ssize_t n{ ::write(fd_, bytes, length) };
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) return false;
+      bytes += n;
+      length -= static_cast<std::size_t>(n);
+      written_ += static_cast<uint64_t>(n);
+    }
+    return this->after_write();
+  }
+
+  // Copies [offset, offset + length) of `source`. With O_DIRECT reads
+  // start on an aligned offset and the leading bytes are skipped.
+  bool copy_from(const FileHandle& source, bool direct, uint64_t offset, uint64_t length) {
+    if (!buffer_) {
+      return false;
+    }
+
+    const uint64_t alignment{ direct ? direct_io_alignment : 1 };
+    while (length > 0) {
+      uint64_t start{ offset - offset % alignment };
+      std::size_t skip{ static_cast<std::size_t>(offset - start) };
+      uint64_t wanted{ std::min<uint64_t>(copy_buffer_size, skip + length) };
+      wanted = (wanted + alignment - 1) / alignment * alignment;
+
+      ssize_t n{ ::pread(source.native_handle(), buffer_, static_cast<std::size_t>(wanted), static_cast<off_t>(start)) };
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= static_cast<ssize_t>(skip)) return false;
+
+      std::size_t usable{ static_cast<std::size_t>(std::min<uint64_t>(static_cast<uint64_t>(n) - skip, length)) };
+      if (!this->write(buffer_ + skip, usable)) {
+        return false;
+      }
+      offset += usable;
+      length -= usable;
+    }
+    return true;
+  }
+
+  bool finish() {
+    return ::fdatasync(fd_) == 0;
+  }
+
+private:
+  bool after_write() {
+    if (written_ - flushed_ >= flush_interval) {
+      ::fdatasync(fd_);
+      ::posix_fadvise(fd_, static_cast<off_t>(flushed_), static_cast<off_t>(written_ - flushed_), POSIX_FADV_DONTNEED);
+      flushed_ = written_;
+    }
+
+    if (rate_ > 0) {
+      auto due{ started_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(static_cast<double>(written_) / static_cast<double>(rate_))) };
+      for (auto now{ std::chrono::steady_clock::now() }; now < due && !stop_.stop_requested();
+           now = std::chrono::steady_clock::now()) {
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(due - now, std::chrono::milliseconds{ 100 }));
+      }
+    }
+    return !stop_.stop_requested();
+  }
+
+  int fd_;
+  uint64_t rate_;
+  std::stop_token stop_;
+  std::chrono::steady_clock::time_point started_;
+  char* buffer_;
+  uint64_t written_{ 0 };
+  uint64_t flushed_{ 0 };
+};
+
+// Copies are named after the media id, so a name is all it takes to tell
+// ours apart from anything else in the output directory.
+bool is_copy_name(std::string_view name) {
+  if (name.ends_with(".part")) {
+    name.remove_suffix(5);
+  }
+  return name.size() == 20 && name.ends_with(".mp4")
+    && core::MediaId::parse(name.substr(0, 16)).has_value();
+}
+
+} // namespace
+
+FaststartOptimizer::FaststartOptimizer(
+  std::shared_ptr<FileSystemRepository>  repository,
+  Options                                options
+)
+  : repository_(std::move(repository))
+  , options_(std::move(options))
+{}
+
+bool FaststartOptimizer::needs_faststart(const core::MediaInfo& media) {
+  const auto& container{ media.container };
+  return container.format == core::ContainerInfo::Format::mp4
+    && !container.fragmented
+    && container.index_size > 0
+    && container.media_offset > 0
+    && container.index_offset > container.media_offset
+    && media.inode != 0;
+}
+
+void FaststartOptimizer::run(core::Job& job) {
+  auto stop{ job.stop_token() };
+
+  std::error_code ec;
+  std::filesystem::create_directories(options_.output_root, ec);
+  if (ec) {
+    throw std::runtime_error("cannot create " + options_.output_root.string() + ": " + ec.message());
+  }
+
+  // Files catalogued mid-run are picked up by walking again until a pass
+  // finds nothing it has not tried; anything triggered after the last pass
+  // has a follow-up run queued behind this one.
+  std::unordered_map<core::MediaId, std::chrono::system_clock::time_point> tried;
+  for (bool found{ true }; found;) {
+    found = false;
+    for (const auto& media : repository_->list_all()) {
+      if (stop.stop_requested()) {
+        return;
+      }
+      if (!needs_faststart(media) || faststart_copy(media)) {
+        continue;
+      }
+      auto [it, inserted]{ tried.try_emplace(media.id, media.modified_at) };
+      if (!inserted && it->second == media.modified_at) {
+        continue;
+      }
+      it->second = media.modified_at;
+      found = true;
+      this->optimize(job, media, stop);
+    }
+  }
+
+  this->remove_orphans();
+}
+
+void FaststartOptimizer::optimize(
+  core::Job&              job,
+  const core::MediaInfo&  media,
+  std::stop_token         stop
+) {
+  auto hex{ media.id.hex() };
+  auto target{ options_.output_root / (std::string(hex.data(), hex.size()) + ".mp4") };
+
+  // A copy left from before a restart is reused if it checks out.
+  core::MediaInfo recorded{ media };
+  recorded.optimized_path = target.string();
+  if (!faststart_copy(recorded) && this->write_copy(media, target, stop) != Outcome::written) {
+    return;
+  }
+
+  // The entry may have changed while we copied; the copy is then stale.
+  std::error_code ec;
+  if (repository_->set_optimized_path(media, target.string())) {
+    job.add_files();
+  } else {
+    std::filesystem::remove(target, ec);
+  }
+}
+
+FaststartOptimizer::Outcome FaststartOptimizer::write_copy(
+  const core::MediaInfo&        media,
+  const std::filesystem::path&  target,
+  std::stop_token               stop
+) {
+  std::error_code ec;
+  FileHandle source{ FileHandle::open_read(media.file_path, ec) };
+  if (ec) {
+    return Outcome::failed;
+  }
+
+  auto status{ source.status(ec) };
+  if (ec || status.size != media.file_size || status.modified_at != media.modified_at) {
+    return Outcome::skipped;   // changed since it was scanned; a rescan will pick it up
+  }
+  const uint64_t file_size{ status.size };
+
+  auto boxes{ read_top_level(source, file_size) };
+  if (!boxes) {
+    return Outcome::skipped;
+  }
+
+  const TopLevelBox* first_media{ nullptr };
+  const TopLevelBox* moov{ nullptr };
+  for (const auto& box : *boxes) {
+    if (box.type == fourcc("moof") || (box.type == fourcc("moov") && moov)) {
+      return Outcome::skipped;
+    }
+    if (box.type == fourcc("mdat") && !first_media) {
+      first_media = &box;
+    }
+    if (box.type == fourcc("moov")) {
+      moov = &box;
+    }
+  }
+  if (!moov || !first_media || moov->offset < first_media->offset || moov->size > max_moov_bytes) {
+    return Outcome::skipped;
+  }
+
+  std::vector<unsigned char> moov_box(moov->size);
+  if (!source.read_exact(moov_box.data(), moov_box.size(), moov->offset)) {
+    return Outcome::failed;
+  }
+
+  if (moov->to_end) {
+    if (moov->size > std::numeric_limits<uint32_t>::max()) {
+      return Outcome::skipped;
+    }
+    write_be(moov_box.data(), moov->size, 4);
+  }
+
+  const uint64_t insert_at{ first_media->offset };
+  const uint64_t moov_end{ moov->offset + moov->size };
+  const Shift shift{ insert_at, moov->offset, moov->size };
+  if (!shift_chunk_offsets(std::span(moov_box).subspan(moov->header), shift)) {
+    LOG_INFO("No faststart copy of ", media.file_path, ": its moov cannot be moved as is");
+    return Outcome::skipped;
+  }
+
+  auto temp_path{ target };
+  temp_path += ".part";
+
+  int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    LOG_WARN("No faststart copy of ", media.file_path, ": ", temp_path.string(), ": ", std::strerror(errno));
+    return Outcome::failed;
+  }
+
+  // The bulk of the copy bypasses the page cache where the filesystem
+  // allows it, so it does not evict what streams are using.
+  std::error_code direct_ec;
+  FileHandle direct_source{ FileHandle::open_read(media.file_path, direct_ec, O_DIRECT) };
+  const bool direct{ !direct_ec };
+  const FileHandle& bulk{ direct ? direct_source : source };
+  if (!direct) {
+    ::posix_fadvise(source.native_handle(), 0, 0, POSIX_FADV_SEQUENTIAL);
+  }
+
+  // Leading boxes, the moov, the media it now precedes, anything after.
+  bool ok{ false };
+  {
+    CopyWriter writer{ fd, options_.max_bytes_per_second, stop };
+    ok = writer.copy_from(bulk, direct, 0, insert_at)
+      && writer.write(moov_box.data(), moov_box.size())
+      && writer.copy_from(bulk, direct, insert_at, moov->offset - insert_at)
+      && writer.copy_from(bulk, direct, moov_end, file_size - moov_end)
+      && writer.finish();
+  }
+  ::close(fd);
+
+  if (!ok || ::rename(temp_path.c_str(), target.c_str()) != 0) {
+    ::unlink(temp_path.c_str());
+    if (stop.stop_requested()) {
+      return Outcome::cancelled;
+    }
+    LOG_WARN("Failed to write faststart copy of ", media.file_path);
+    return Outcome::failed;
+  }
+
+  // Check the copy the way a scan would see it before anyone is served it.
+  auto probed{ probe_container(target.string(), file_size) };
+  if (!probed.faststart || probed.duration_ms != media.container.duration_ms
+      || probed.track_count != media.container.track_count) {
+    LOG_WARN("Discarding faststart copy of ", media.file_path, ": it does not probe like the source");
+    std::filesystem::remove(target, ec);
+    return Outcome::failed;
+  }
+
+  LOG_INFO("Wrote faststart copy of ", media.file_path, " (", moov->size, " byte moov moved ahead)");
+  return Outcome::written;
+}
+
+void FaststartOptimizer::remove_orphans() {
+  std::unordered_set<std::string> referenced;
+  for (const auto& media : repository_->list_all()) {
+    if (!media.optimized_path.empty()) {
+      referenced.insert(media.optimized_path);
+    }
+  }
+
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(options_.output_root, ec)) {
+    if (is_copy_name(entry.path().filename().native()) && !referenced.contains(entry.path().native())) {
+      LOG_DEBUG("Removing stale faststart copy ", entry.path().string());
+      std::filesystem::remove(entry.path(), ec);
+    }
+  }
+}
+
+std::optional<core::MediaInfo> faststart_copy(const core::MediaInfo& media) {
+  if (media.optimized_path.empty()) {
+    return std::nullopt;
+  }
+
+  // A remux moves boxes without resizing any, so the sizes must agree;
+  // and the copy must have been made after the source last changed.
+  std::error_code ec;
+  auto status{ FileHandle::stat(media.optimized_path, ec) };
+  if (ec || status.size != media.file_size || status.modified_at < media.modified_at) {
+    return std::nullopt;
+  }
+
+  core::MediaInfo copy{ media };
+  copy.file_path = media.optimized_path;
+  copy.optimized_path.clear();
+  copy.inode = status.inode;
+  copy.modified_at = status.modified_at;
+
+  // The moov now sits where the media data started, which moved up by
+  // the moov's size.
+  auto& container{ copy.container };
+  container.index_offset = media.container.media_offset;
+  container.media_offset = media.container.media_offset + container.index_size;
+  container.faststart = true;
+  return copy;
+}
+
+} // namespace venturi::adapters
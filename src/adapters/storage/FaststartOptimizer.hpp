@@ -0,0 +1,71 @@
+#pragma once
+#include "../../core/entities/MediaInfo.hpp"
+#include "../../core/services/JobManager.hpp"
+#include "FileSystemRepository.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <stop_token>
+
+namespace venturi::adapters {
+
+// Gives MP4s whose moov box trails their media data a "faststart" copy
+// with the moov in front, so a player can start from the first bytes
+// instead of fetching the tail and seeking back.
+//
+// The copy is a pure remux: every box is copied as is, the moov moves to
+// just before the first mdat, and its chunk offsets (stco/co64) are
+// shifted by its size. Files that would need more (a compressed moov,
+// absolute aux-info offsets, 32-bit offsets that would overflow) are left
+// alone. Copies are named after the media id under `output_root`, probed
+// before use, and recorded as the entry's optimized_path.
+//
+// Meant to run as a background job, whose workers already have idle I/O
+// priority. The copy is also throttled to `max_bytes_per_second` and
+// flushed as it goes, so it neither competes with streams for the disk nor
+// floods the page cache with dirty pages.
+class FaststartOptimizer {
+public:
+  struct Options {
+    std::filesystem::path output_root;
+    uint64_t max_bytes_per_second{ 0 };   // 0: unthrottled
+  };
+
+  FaststartOptimizer(std::shared_ptr<FileSystemRepository> repository, Options options);
+
+  // Copies every catalogued file that needs it, then deletes copies that
+  // no entry refers to any more. Counts files copied on `job`.
+  void run(core::Job& job);
+
+  static bool needs_faststart(const core::MediaInfo& media);
+
+private:
+  enum class Outcome { written, skipped, failed, cancelled };
+
+  // Writes or reuses the copy of `media` and records it.
+  void optimize(
+    core::Job&              job,
+    const core::MediaInfo&  media,
+    std::stop_token         stop
+  );
+
+  Outcome write_copy(
+    const core::MediaInfo&        media,
+    const std::filesystem::path&  target,
+    std::stop_token               stop
+  );
+
+  void remove_orphans();
+
+  std::shared_ptr<FileSystemRepository> repository_;
+  Options options_;
+};
+
+// What is served for `media`: its faststart copy, described by the copy's
+// own stat and layout so that validators and caches tell the two apart.
+// Nullopt when the entry has no copy or the copy no longer matches.
+std::optional<core::MediaInfo> faststart_copy(const core::MediaInfo& media);
+
+} // namespace venturi::adapters
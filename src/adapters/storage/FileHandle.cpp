@@ -0,0 +1,105 @@
+#include "FileHandle.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+
+namespace venturi::adapters {
+
+namespace {
+
+FileHandle::Status to_status(const struct stat& st) {
+  FileHandle::Status status;
+  status.size = static_cast<uint64_t>(st.st_size);
+  status.inode = static_cast<uint64_t>(st.st_ino);
+  status.modified_at = std::chrono::system_clock::time_point{
+    std::chrono::duration_cast<std::chrono::system_clock::duration>(
+      std::chrono::seconds{ st.st_mtim.tv_sec } + std::chrono::nanoseconds{ st.st_mtim.tv_nsec }
+    )
+  };
+  return status;
+}
+
+} // namespace
+
+FileHandle FileHandle::open_read(
+  const char*       path,
+  std::error_code&  ec,
+  int               extra_flags
+) {
+  ec.clear();
+
+  int fd{ -1 };
+  do {
+    fd = ::open(path, O_RDONLY | O_CLOEXEC | extra_flags);
+  } while (fd < 0 && errno == EINTR);
+
+  if (fd < 0) {
+    ec.assign(errno, std::system_category());
+  }
+
+  return FileHandle{ fd };
+}
+
+uint64_t FileHandle::size(std::error_code& ec) const {
+  ec.clear();
+
+  struct stat st{};
+  if (::fstat(fd_, &st) != 0) {
+    ec.assign(errno, std::system_category());
+    return 0;
+  }
+
+  return static_cast<uint64_t>(st.st_size);
+}
+
+FileHandle::Status FileHandle::stat(
+  const std::filesystem::path&  path,
+  std::error_code&              ec
+) {
+  ec.clear();
+
+  struct stat st{};
+  if (::stat(path.c_str(), &st) != 0) {
+    ec.assign(errno, std::system_category());
+    return {};
+  }
+
+  return to_status(st);
+}
+
+FileHandle::Status FileHandle::status(std::error_code& ec) const {
+  ec.clear();
+
+  struct stat st{};
+  if (::fstat(fd_, &st) != 0) {
+    ec.assign(errno, std::system_category());
+    return {};
+  }
+
+  return to_status(st);
+}
+
+bool FileHandle::read_exact(void* data, std::size_t length, uint64_t offset) const {
+  auto* out{ static_cast<char*>(data) };
+  while (length > 0) {
+    ssize_t n{ ::pread(fd_, out, length, static_cast<off_t>(offset)) };
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+
+    out += n;
+    length -= static_cast<std::size_t>(n);
+    offset += static_cast<uint64_t>(n);
+  }
+  return true;
+}
+
+void FileHandle::close() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+} // namespace venturi::adapters
@@ -0,0 +1,73 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace venturi::adapters {
+
+// Move-only owner of a read-only POSIX file descriptor.
+class FileHandle {
+public:
+  FileHandle() = default;
+  explicit FileHandle(int fd) : fd_(fd) {}
+
+  ~FileHandle() { this->close(); }
+
+  FileHandle(FileHandle&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1))
+  {}
+
+  FileHandle& operator=(FileHandle&& other) noexcept {
+    if (this != &other) {
+      this->close();
+      fd_ = std::exchange(other.fd_, -1);
+    }
+    return *this;
+  }
+
+  FileHandle(const FileHandle&) = delete;
+  FileHandle& operator=(const FileHandle&) = delete;
+
+  static FileHandle open_read(
+    const char*       path,
+    std::error_code&  ec,
+    int               extra_flags = 0
+  );
+
+  // Catalog entries keep paths as plain strings; neither form is parsed.
+  static FileHandle open_read(const std::filesystem::path& path, std::error_code& ec, int extra_flags = 0) {
+    return open_read(path.c_str(), ec, extra_flags);
+  }
+  static FileHandle open_read(const std::string& path, std::error_code& ec, int extra_flags = 0) {
+    return open_read(path.c_str(), ec, extra_flags);
+  }
+
+  struct Status {
+    uint64_t size{ 0 };
+    uint64_t inode{ 0 };
+    std::chrono::system_clock::time_point modified_at;
+  };
+
+  // stat(2) of `path` without opening it.
+  static Status stat(const std::filesystem::path& path, std::error_code& ec);
+
+  uint64_t size(std::error_code& ec) const;
+  Status status(std::error_code& ec) const;
+
+  // pread(2)s exactly `length` bytes at `offset`; false on error or EOF.
+  bool read_exact(void* data, std::size_t length, uint64_t offset) const;
+
+  int native_handle() const { return fd_; }
+  bool is_open() const { return fd_ >= 0; }
+
+  void close();
+
+private:
+  int fd_{ -1 };
+};
+
+} // namespace venturi::adapters
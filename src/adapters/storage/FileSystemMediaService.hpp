@@ -0,0 +1,11 @@
+#pragma once
+#include "../../core/services/MediaService.hpp"
+#include "FileSystemRepository.hpp"
+
+namespace venturi::adapters {
+
+// The service the server is built on, bound to the file system repository
+// at compile time.
+using MediaService = core::MediaService<FileSystemRepository>;
+
+} // namespace venturi::adapters
@@ -1,172 +1,458 @@
 #include "FileSystemRepository.hpp"
+#include "FileHandle.hpp"
+#include "CatalogIndex.hpp"
+#include "ContainerProber.hpp"
 #include "../../../app/Logger.hpp"
 #include <algorithm>
-#include <sstream>
-#include <iomanip>
+#include <cctype>
 
 namespace venturi::adapters {
 
+namespace {
+
+// Same rule as path::extension(), without building a path.
+std::string_view extension_of(std::string_view path) {
+  auto name = path.substr(path.rfind('/') + 1);
+  auto dot = name.rfind('.');
+  if (dot == std::string_view::npos || dot == 0) {
+    return {};
+  }
+  return name.substr(dot);
+}
+
+} // namespace
+
 FileSystemRepository::FileSystemRepository(
   const std::filesystem::path& media_root,
-  const std::filesystem::path& optimized_root
+  const std::filesystem::path& optimized_root,
+  ParallelScanner::Options scan_options,
+  std::filesystem::path index_path,
+  bool probe_containers
 ) : media_root_(media_root),
-  optimized_root_(optimized_root)
+  absolute_root_(std::filesystem::absolute(media_root).lexically_normal()),
+  optimized_root_(optimized_root),
+  scan_options_(scan_options),
+  index_path_(std::move(index_path)),
+  probe_containers_(probe_containers),
+  catalog_(CatalogSnapshot::build({}, 1))
 {
+  root_prefix_ = absolute_root_.native();
+  if (!root_prefix_.ends_with('/')) {
+    root_prefix_ += '/';
+  }
+
+  // Only matters when the copies live inside the library.
+  if (!optimized_root_.empty()) {
+    optimized_prefix_ = std::filesystem::absolute(optimized_root_).lexically_normal().native();
+    if (!optimized_prefix_.ends_with('/')) {
+      optimized_prefix_ += '/';
+    }
+    if (!optimized_prefix_.starts_with(root_prefix_)) {
+      optimized_prefix_.clear();
+    }
+  }
+
   // Ensure directories exist
   std::error_code ec;
   std::filesystem::create_directories(media_root_, ec);
   // std::filesystem::create_directories(optimized_root_, ec);
 }
 
-std::optional<core::MediaInfo> FileSystemRepository::find_by_id(
-  const std::string& id
-) const {
-  std::shared_lock lock(mutex_);
+size_t FileSystemRepository::load_index() {
+  if (index_path_.empty()) {
+    return 0;
+  }
 
-  auto it = media_map_.find(id);
-  if (it == media_map_.end()) {
-    return std::nullopt;
+  auto entries = read_catalog_index(index_path_, absolute_root_);
+  if (!entries) {
+    return 0;
   }
-  
-  return it->second;
+
+  CatalogSnapshot::Handles media;
+  media.reserve(entries->size());
+  for (auto& entry : *entries) {
+    auto info = create_media_info(std::move(entry.file_path), { entry.file_size, entry.inode, entry.modified_at });
+    info.optimized_path = std::move(entry.optimized_path);
+    info.mime_type = core::parse_mime_type(entry.mime_type).value_or(info.mime_type);
+    info.created_at = entry.created_at;
+    info.container = entry.container;
+    media.push_back(std::make_shared<const core::MediaInfo>(std::move(info)));
+  }
+  size_t count = media.size();
+
+  std::lock_guard lock(write_mutex_);
+  auto current = snapshot();
+  if (current->empty()) {
+    // The index is written in path order, so this is a single pass.
+    this->replace_locked(CatalogSnapshot::build(std::move(media), current->generation() + 1));
+  } else {
+    publish_locked(std::move(media));
+  }
+
+  return count;
 }
 
-std::vector<core::MediaInfo> FileSystemRepository::list_all() const {
-  std::shared_lock lock(mutex_);
-  
-  std::vector<core::MediaInfo> result;
-  result.reserve(media_map_.size());
-  
-  for (const auto& [id, info] : media_map_) {
-    result.push_back(info);
+void FileSystemRepository::store_index() const {
+  auto media = list_all();
+
+  std::lock_guard lock(index_mutex_);
+  if (write_catalog_index(index_path_, absolute_root_, media)) {
+    LOG_DEBUG("Saved catalog index: ", media.size(), " entries");
   }
-  
-  std::sort(result.begin(), result.end(),
-    [](const auto& a, const auto& b) {
-      return a.file_path < b.file_path;
-    });
-  
-  return result;
+}
+
+core::MediaList FileSystemRepository::list_all() const {
+  auto catalog = snapshot();
+  auto entries = catalog->entries();
+  return { std::move(catalog), entries };
+}
+
+core::MediaList FileSystemRepository::list_page(
+  const std::filesystem::path& after,
+  std::size_t limit
+) const {
+  auto catalog = snapshot();
+  auto rest = catalog->after(after);
+  auto page = rest.first(std::min(limit, rest.size()));
+  return { std::move(catalog), page };
 }
 
 size_t FileSystemRepository::scan_directory(
   const std::filesystem::path& path,
-  std::function<void(const core::MediaInfo&)> on_found
+  const core::ScanHooks& hooks
 ) {
-  size_t count = 0;
-  std::error_code ec;
-  
-  for (const auto& entry : 
-      std::filesystem::recursive_directory_iterator(path, ec)) {
-    
-    if (ec) {
-      LOG_WARN("Error scanning directory: ", ec.message());
-      ec.clear();
-      continue;
+  // The library watcher may refresh files while this walk is going, and
+  // other scans (a new directory, a rescan) may publish below `path`. Their
+  // stat can be more recent than ours, so whatever they wrote after we
+  // started is left alone, both when merging and when pruning.
+  uint64_t started = 0;
+  {
+    std::lock_guard lock(write_mutex_);
+    started = begin_scan_locked();
+  }
+
+  // Ids found by this scan; anything else under `path` has vanished.
+  std::unordered_set<core::MediaId> seen;
+  std::mutex seen_mutex;
+
+  // Each scan thread hands over a batch of stat'ed files, which becomes at
+  // most one new catalog version.
+  auto merge = [this, &hooks, &seen, &seen_mutex, started](std::vector<ParallelScanner::Entry>&& batch) {
+    CatalogSnapshot::Handles media;
+    media.reserve(batch.size());
+    auto current = snapshot();
+    for (auto& entry : batch) {
+      if (is_optimized_copy(entry.path)) {
+        continue;
+      }
+      auto info = create_media_info(std::move(entry.path), entry.status);
+      fill_derived(info, *current);
+      media.push_back(std::make_shared<const core::MediaInfo>(std::move(info)));
     }
-    
-    if (!entry.is_regular_file(ec)) {
-      continue;
+
+    {
+      std::lock_guard lock(seen_mutex);
+      for (const auto& info : media) {
+        seen.insert(info->id);
+      }
     }
-    
-    if (!is_video_file(entry.path())) {
-      continue;
+
+    {
+      std::lock_guard lock(write_mutex_);
+      CatalogSnapshot::Handles fresh;
+      fresh.reserve(media.size());
+      ++write_sequence_;
+      for (const auto& info : media) {
+        if (!claimed_since_locked(*info, started)) {
+          claim_locked(info->id);
+          fresh.push_back(info);
+        }
+      }
+      publish_locked(std::move(fresh));
+    }
+
+    if (hooks.on_found) {
+      for (const auto& info : media) {
+        hooks.on_found(*info);
+      }
     }
-    
-    auto info = create_media_info(entry.path());
-    
-    save(info);
-    
-    if (on_found) {
-      on_found(info);
+  };
+
+  ParallelScanner scanner(scan_options_);
+  size_t count = scanner.scan(path, &FileSystemRepository::is_video_name, merge, hooks);
+  const bool complete = !hooks.stop_token.stop_requested();
+
+  // Only a complete walk can tell which files are gone.
+  size_t removed = 0;
+  {
+    std::lock_guard lock(write_mutex_);
+    if (complete) {
+      std::vector<core::MediaId> removals;
+      for (const auto& media : snapshot()->under(path)) {
+        if (!seen.contains(media->id) && !claimed_since_locked(*media, started)) {
+          removals.push_back(media->id);
+        }
+      }
+      removed = removals.size();
+      if (!publish_locked({}, std::move(removals))) {
+        removed = 0;
+      }
     }
-    
-    count++;
+    end_scan_locked();
   }
-  
+
+  if (!complete) {
+    LOG_INFO("Scan of ", path.string(), " stopped after ", count, " files");
+    return count;
+  }
+
+  if (removed > 0) {
+    LOG_INFO("Removed ", removed, " vanished media files under ", path.string());
+  }
+
+  // A walk covering the whole library leaves the catalog in step with the
+  // disk, which is what the next startup should begin from.
+  if (!index_path_.empty()
+      && is_under(absolute_root_, path.lexically_normal())) {
+    store_index();
+  }
+
   return count;
 }
 
-void FileSystemRepository::save(const core::MediaInfo& info) {
-  std::unique_lock lock(mutex_);
-  media_map_[info.id] = info;
+bool FileSystemRepository::refresh(const std::vector<std::filesystem::path>& file_paths) {
+  CatalogSnapshot::Handles upserts;
+  std::vector<const std::filesystem::path*> gone;
+  auto known = snapshot();
+
+  for (const auto& file_path : file_paths) {
+    std::error_code ec;
+    auto status = FileHandle::stat(file_path, ec);
+
+    if (is_optimized_copy(file_path.native())) {
+      continue;
+    }
+
+    // stat(2) follows links; only regular files are catalogued.
+    if (!ec && is_video_name(file_path.filename().native())
+        && std::filesystem::is_regular_file(file_path, ec)) {
+      auto info = create_media_info(file_path.native(), status);
+      fill_derived(info, *known);
+      upserts.push_back(std::make_shared<const core::MediaInfo>(std::move(info)));
+    } else {
+      gone.push_back(&file_path);
+    }
+  }
+
+  std::lock_guard lock(write_mutex_);
+
+  ++write_sequence_;
+  std::vector<core::MediaId> removals;
+  auto current = snapshot();
+  for (const auto* file_path : gone) {
+    if (auto media = current->find_by_path(*file_path)) {
+      removals.push_back(media->id);
+    }
+    // Also when not catalogued: a scan may have stat'ed it before it went.
+    claim_locked(generate_media_id(file_path->native()));
+  }
+  for (const auto& info : upserts) {
+    claim_locked(info->id);
+  }
+
+  return publish_locked(std::move(upserts), std::move(removals));
+}
+
+size_t FileSystemRepository::remove_under(const std::filesystem::path& directory) {
+  std::lock_guard lock(write_mutex_);
+
+  ++write_sequence_;
+  if (active_scans_ > 0) {
+    claimed_directories_.emplace_back(directory, write_sequence_);
+  }
+
+  std::vector<core::MediaId> removals;
+  for (const auto& media : snapshot()->under(directory)) {
+    removals.push_back(media->id);
+  }
+
+  size_t removed = removals.size();
+  return publish_locked({}, std::move(removals)) ? removed : 0;
+}
+
+uint64_t FileSystemRepository::begin_scan_locked() {
+  ++active_scans_;
+  return write_sequence_;
+}
+
+void FileSystemRepository::end_scan_locked() {
+  if (--active_scans_ == 0) {
+    claimed_ids_.clear();
+    claimed_directories_.clear();
+  }
+}
+
+void FileSystemRepository::claim_locked(core::MediaId id) {
+  if (active_scans_ > 0) {
+    claimed_ids_.insert_or_assign(id, write_sequence_);
+  }
+}
+
+bool FileSystemRepository::claimed_since_locked(const core::MediaInfo& info, uint64_t since) const {
+  if (auto it = claimed_ids_.find(info.id); it != claimed_ids_.end() && it->second > since) {
+    return true;
+  }
+  return std::any_of(claimed_directories_.begin(), claimed_directories_.end(),
+    [&](const auto& claim) {
+      return claim.second > since && is_under(std::filesystem::path(info.file_path), claim.first);
+    });
+}
+
+bool FileSystemRepository::set_optimized_path(
+  const core::MediaInfo&  source,
+  std::string             optimized_path
+) {
+  std::lock_guard lock(write_mutex_);
+
+  auto current = snapshot()->find_by_id(source.id);
+  if (!current
+      || current->file_path != source.file_path
+      || current->inode != source.inode
+      || current->file_size != source.file_size
+      || current->modified_at != source.modified_at) {
+    return false;
+  }
+
+  auto updated = std::make_shared<core::MediaInfo>(*current);
+  updated->optimized_path = std::move(optimized_path);
+  publish_locked({ std::move(updated) });
+  return true;
+}
+
+bool FileSystemRepository::publish(
+  CatalogSnapshot::Handles    upserts,
+  std::vector<core::MediaId>  removals
+) {
+  std::lock_guard lock(write_mutex_);
+  return publish_locked(std::move(upserts), std::move(removals));
+}
+
+bool FileSystemRepository::publish_locked(
+  CatalogSnapshot::Handles    upserts,
+  std::vector<core::MediaId>  removals
+) {
+  auto next = snapshot()->with_changes(std::move(upserts), std::move(removals));
+  if (!next) {
+    return false;
+  }
+
+  this->replace_locked(std::move(next));
+  return true;
+}
+
+void FileSystemRepository::replace_locked(std::shared_ptr<const CatalogSnapshot> next) {
+  // Hold on to the outgoing version until the next publish. Readers are
+  // done with it by then, so freeing it falls to a writer instead of to a
+  // reader that happens to drop the last reference mid-request.
+  retired_ = catalog_.exchange(std::move(next), std::memory_order_acq_rel);
 }
 
-bool FileSystemRepository::remove(const std::string& id) {
-  std::unique_lock lock(mutex_);
-  return media_map_.erase(id) > 0;
+void FileSystemRepository::save(const core::MediaInfo& info) {
+  publish({ std::make_shared<const core::MediaInfo>(info) });
 }
 
-bool FileSystemRepository::exists(const std::string& id) const {
-  std::shared_lock lock(mutex_);
-  return media_map_.find(id) != media_map_.end();
+bool FileSystemRepository::remove(core::MediaId id) {
+  return publish({}, { id });
 }
 
 core::MediaInfo FileSystemRepository::create_media_info(
-  const std::filesystem::path& file_path
+  std::string file_path,
+  const FileHandle::Status& status
 ) const {
   core::MediaInfo info;
   
   info.id = generate_media_id(file_path);
-  info.file_path = file_path;
+  info.file_path = std::move(file_path);
   
-  std::error_code ec;
-  auto ftime = std::filesystem::last_write_time(file_path, ec);
-  if (!ec) {
-    auto sctp = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
-      ftime - std::filesystem::file_time_type::clock::now() +
-      std::chrono::system_clock::now()
-    );
-    info.modified_at = sctp;
+  // Straight from stat(2): converting file_time_type through now() would
+  // give a slightly different modified_at on every scan.
+  if (status.inode != 0) {
+    info.modified_at = status.modified_at;
+    info.inode = status.inode;
+    info.file_size = status.size;
   }
   
   info.created_at = std::chrono::system_clock::now();
-  
-  // Set MIME type based on extension
-  auto ext = file_path.extension().string();
-  std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-  
-  if (ext == ".mp4") {
-    info.mime_type = "video/mp4";
-  } else if (ext == ".webm") {
-    info.mime_type = "video/webm";
-  } else if (ext == ".mkv") {
-    info.mime_type = "video/x-matroska";
-  } else if (ext == ".avi") {
-    info.mime_type = "video/x-msvideo";
-  } else {
-    info.mime_type = "video/mp4"; // Default
-  }
+  info.mime_type = core::mime_type_for_extension(extension_of(info.file_path));
   
   return info;
 }
 
-std::string FileSystemRepository::generate_media_id(
-  const std::filesystem::path& file_path
-) const {  
-  auto path_str = file_path.string();
-  std::hash<std::string> hasher;
-  size_t hash = hasher(path_str);
-  
-  std::ostringstream oss;
-  oss << std::hex << std::setfill('0') << std::setw(16) << hash;
-  return oss.str();
+void FileSystemRepository::fill_derived(core::MediaInfo& info, const CatalogSnapshot& current) const {
+  auto known = current.find_by_id(info.id);
+  bool unchanged = known
+    && known->file_path == info.file_path
+    && known->inode == info.inode
+    && known->file_size == info.file_size
+    && known->modified_at == info.modified_at;
+
+  // A faststart copy is only good for the file it was made from.
+  if (unchanged) {
+    info.optimized_path = known->optimized_path;
+  }
+
+  if (!probe_containers_ || info.inode == 0) {
+    return;
+  }
+
+  if (unchanged && known->container.probed()) {
+    info.container = known->container;
+    return;
+  }
+
+  info.container = probe_container(info.file_path, info.file_size);
+}
+
+bool FileSystemRepository::is_optimized_copy(std::string_view file_path) const {
+  if (optimized_prefix_.empty()) {
+    return false;
+  }
+  if (file_path.starts_with('/')) {
+    return file_path.starts_with(optimized_prefix_);
+  }
+  return std::filesystem::absolute(file_path).lexically_normal().native().starts_with(optimized_prefix_);
 }
 
-bool FileSystemRepository::is_video_file(
-  const std::filesystem::path& file_path
+core::MediaId FileSystemRepository::generate_media_id(
+  const std::string& file_path
 ) const {
-  static const std::vector<std::string> video_extensions = {
+  // Relative to the root, so ids survive moving the whole library.
+  std::string_view path{ file_path };
+  if (path.starts_with(root_prefix_)) {
+    return core::MediaId::from_relative_path(path.substr(root_prefix_.size()));
+  }
+
+  // Paths from an unnormalized root such as "./media" end up here.
+  auto relative = std::filesystem::path(file_path).lexically_normal().lexically_relative(absolute_root_);
+  return core::MediaId::from_relative_path(relative.native());
+}
+
+bool FileSystemRepository::is_video_name(std::string_view file_name) {
+  static constexpr std::string_view video_extensions[] = {
     ".mp4", ".m4v", ".mkv", ".webm", ".avi", ".mov", 
     ".wmv", ".flv", ".mpg", ".mpeg"
   };
   
-  auto ext = file_path.extension().string();
-  std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+  auto ext = extension_of(file_name);
+  if (ext.empty()) {
+    return false;
+  }
   
-  return std::find(video_extensions.begin(), 
-                    video_extensions.end(), 
-                    ext) != video_extensions.end();
+  return std::any_of(std::begin(video_extensions), std::end(video_extensions),
+    [ext](std::string_view candidate) {
+      return std::equal(ext.begin(), ext.end(), candidate.begin(), candidate.end(),
+        [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; });
+    });
 }
 
 uint64_t FileSystemRepository::get_file_size(const std::filesystem::path& file_path) const {
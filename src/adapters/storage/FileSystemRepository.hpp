@@ -1,50 +1,142 @@
 #pragma once
-#include "../../core/ports/IMediaRepository.hpp"
+#include "../../core/ports/MediaRepository.hpp"
+#include "CatalogSnapshot.hpp"
+#include "FileHandle.hpp"
+#include "ParallelScanner.hpp"
 #include <unordered_map>
-#include <shared_mutex>
+#include <unordered_set>
+#include <mutex>
+#include <atomic>
 #include <filesystem>
 
 namespace venturi::adapters {
 
-class FileSystemRepository : public core::IMediaRepository {
+// Lookups and listings read the current CatalogSnapshot without taking a
+// lock; writers are serialized, derive the next snapshot and publish it
+// atomically, so a scan never stalls stream starts.
+//
+// Satisfies core::MediaRepository; the lookups are defined inline so that
+// services bound to this type compile them into the request path.
+class FileSystemRepository {
 public:
   explicit FileSystemRepository(
     const std::filesystem::path& media_root,
-    const std::filesystem::path& optimized_root
+    const std::filesystem::path& optimized_root,
+    ParallelScanner::Options scan_options = {},
+    std::filesystem::path index_path = {},
+    bool probe_containers = true
   );
+
+  // Fills the catalog from the saved index, if there is a usable one.
+  // Returns how many entries were restored. Afterwards every complete scan
+  // of the media root rewrites the index.
+  size_t load_index();
   
-  std::optional<core::MediaInfo> find_by_id(
-    const std::string& id
-  ) const override;
+  core::MediaHandle find_by_id(core::MediaId id) const {
+    return snapshot()->find_by_id(id);
+  }
   
-  std::vector<core::MediaInfo> list_all() const override;
+  core::MediaList list_all() const;
+
+  core::MediaList list_page(
+    const std::filesystem::path& after,
+    std::size_t limit
+  ) const;
   
   size_t scan_directory(
     const std::filesystem::path& path,
-    std::function<void(const core::MediaInfo&)> on_found
-  ) override;
+    const core::ScanHooks& hooks
+  );
   
-  void save(const core::MediaInfo& info) override;
-  bool remove(const std::string& id) override;
-  bool exists(const std::string& id) const override;
+  // Brings the entries for these files in line with the disk, as one new
+  // catalog version: video files are added or updated, files that are gone
+  // are dropped. Returns whether the catalog changed. Scans running
+  // meanwhile leave these entries to it (see scan_directory).
+  bool refresh(const std::vector<std::filesystem::path>& file_paths);
+
+  // Drops every entry below `directory`; returns how many. Like refresh(),
+  // wins over scans already running.
+  size_t remove_under(const std::filesystem::path& directory);
+
+  // Records a faststart copy of `source` on its entry, provided the entry
+  // still describes the same file. Returns whether it did.
+  bool set_optimized_path(const core::MediaInfo& source, std::string optimized_path);
+
+  void save(const core::MediaInfo& info);
+  bool remove(core::MediaId id);
+  bool exists(core::MediaId id) const {
+    return snapshot()->find_by_id(id) != nullptr;
+  }
   uint64_t get_file_size(const std::filesystem::path& file_path) const;
+  uint64_t generation() const {
+    return snapshot()->generation();
+  }
+
+  static bool is_video_name(std::string_view file_name);
 
 private:
   core::MediaInfo create_media_info(
-    const std::filesystem::path& file_path
+    std::string file_path,
+    const FileHandle::Status& status
   ) const;
+
+  // Fills in info.container and info.optimized_path from what `current`
+  // holds for the file when it is unchanged, so rescans do not re-read the
+  // library; probes it otherwise.
+  void fill_derived(core::MediaInfo& info, const CatalogSnapshot& current) const;
+
+  // Copies written below optimized_root_ are never catalogued themselves.
+  bool is_optimized_copy(std::string_view file_path) const;
+
+  void store_index() const;
+
+  std::shared_ptr<const CatalogSnapshot> snapshot() const {
+    return catalog_.load(std::memory_order_acquire);
+  }
+
+  // Applies the changes to the current snapshot and publishes the result;
+  // returns whether anything changed. The _locked forms expect
+  // write_mutex_ to be held.
+  bool publish(CatalogSnapshot::Handles upserts, std::vector<core::MediaId> removals = {});
+  bool publish_locked(CatalogSnapshot::Handles upserts, std::vector<core::MediaId> removals = {});
+  void replace_locked(std::shared_ptr<const CatalogSnapshot> next);
+
+  // Scans in flight, and which entries refresh(), remove_under() and scan
+  // batches wrote while they ran. A scan's stat may predate such a write,
+  // so it neither publishes nor prunes anything written after it began.
+  uint64_t begin_scan_locked();
+  void end_scan_locked();
+  void claim_locked(core::MediaId id);
+  bool claimed_since_locked(const core::MediaInfo& info, uint64_t since) const;
   
-  std::string generate_media_id(
-    const std::filesystem::path& file_path
+  core::MediaId generate_media_id(
+    const std::string& file_path
   ) const;
   
-  bool is_video_file(const std::filesystem::path& file_path) const;
-  
+
   std::filesystem::path media_root_;
+  std::filesystem::path absolute_root_;   // normalized; ids hash paths below it
+  std::string root_prefix_;               // absolute_root_ with a trailing '/'
   std::filesystem::path optimized_root_;
+  std::string optimized_prefix_;          // likewise; empty unless inside the root
+  ParallelScanner::Options scan_options_;
+  std::filesystem::path index_path_;
+  bool probe_containers_;
+
+  // Serializes index writers; readers of the catalog are not blocked.
+  mutable std::mutex index_mutex_;
   
-  mutable std::shared_mutex mutex_;
-  std::unordered_map<std::string, core::MediaInfo> media_map_;
+  std::atomic<std::shared_ptr<const CatalogSnapshot>> catalog_;
+  std::mutex write_mutex_;
+  std::shared_ptr<const CatalogSnapshot> retired_;   // guarded by write_mutex_
+
+  // Guarded by write_mutex_; the claims are dropped when no scan runs.
+  uint64_t write_sequence_{ 0 };
+  std::size_t active_scans_{ 0 };
+  std::unordered_map<core::MediaId, uint64_t> claimed_ids_;
+  std::vector<std::pair<std::filesystem::path, uint64_t>> claimed_directories_;
 };
 
+static_assert(core::MediaRepository<FileSystemRepository>);
+
 } // namespace venturi::adapters
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "HeaderCache.hpp"
+#include "../../../app/Logger.hpp"
+
+#include <algorithm>
+
+namespace venturi::adapters {
+
+HeaderCache::HeaderCache(
+  uint64_t    budget_bytes,
+  std::size_t head_bytes,
+  std::size_t tail_bytes
+)
+  : budget_bytes_(budget_bytes)
+  , head_bytes_(head_bytes)
+  , tail_bytes_(tail_bytes)
+{}
+
+std::shared_ptr<const HeaderCache::Entry> HeaderCache::find(
+  const core::MediaInfo& media
+) {
+  std::lock_guard lock(mutex_);
+
+  auto it = entries_.find(media.id);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+
+  if (it->second.entry->modified_at != media.modified_at) {
+    this->erase(it);
+    return nullptr;
+  }
+
+  lru_.splice(lru_.begin(), lru_, it->second.position);
+  return it->second.entry;
+}
+
+bool HeaderCache::load(const core::MediaInfo& media) {
+  if (!this->enabled()) {
+    return false;
+  }
+
+  std::error_code ec;
+  FileHandle file{ FileHandle::open_read(media.file_path, ec) };
+  if (ec) {
+    return false;
+  }
+
+  uint64_t file_size{ file.size(ec) };
+  if (ec) {
+    return false;
+  }
+
+  auto entry = std::make_shared<Entry>();
+  entry->modified_at = media.modified_at;
+  entry->file_size = file_size;
+
+  // Small files are held entirely in `head`.
+  std::size_t head_size{ static_cast<std::size_t>(std::min<uint64_t>(file_size, head_bytes_)) };
+  std::size_t tail_size{ static_cast<std::size_t>(
+    std::min<uint64_t>(file_size - head_size, tail_bytes_)
+  ) };
+
+  // A probed index (moov, Cues) is what players fetch first; hold it whole
+  // when it fits in this file's usual share, trading the other region.
+  const auto& container{ media.container };
+  uint64_t share{ uint64_t{ head_bytes_ } + tail_bytes_ };
+  if (container.index_size > 0 && media.file_size == file_size) {
+    uint64_t index_end{ container.index_offset + container.index_size };
+    if (container.faststart && index_end <= std::min(share, file_size)) {
+      head_size = std::max<std::size_t>(head_size, index_end);
+      tail_size = 0;
+    } else if (!container.faststart && file_size - container.index_offset <= share) {
+      tail_size = std::max<std::size_t>(tail_size, file_size - std::max<uint64_t>(container.index_offset, head_size));
+    }
+  }
+
+  entry->head.resize(head_size);
+  entry->tail.resize(tail_size);
+
+  if (!file.read_exact(entry->head.data(), head_size, 0) ||
+      !file.read_exact(entry->tail.data(), tail_size, file_size - tail_size)) {
+    LOG_WARN("Failed to cache header of ", media.file_path);
+    return false;
+  }
+
+  if (entry->bytes() > budget_bytes_) {
+    return false;
+  }
+
+  this->insert(media.id, std::move(entry));
+  return true;
+}
+
+void HeaderCache::invalidate(core::MediaId id) {
+  std::lock_guard lock(mutex_);
+
+  if (auto it = entries_.find(id); it != entries_.end()) {
+    this->erase(it);
+  }
+}
+
+void HeaderCache::insert(core::MediaId id, std::shared_ptr<const Entry> entry) {
+  std::lock_guard lock(mutex_);
+
+  if (auto it = entries_.find(id); it != entries_.end()) {
+    this->erase(it);
+  }
+
+  used_bytes_ += entry->bytes();
+  lru_.push_front(id);
+  entries_.emplace(id, Slot{ std::move(entry), lru_.begin() });
+
+  while (used_bytes_ > budget_bytes_ && !lru_.empty()) {
+    this->erase(entries_.find(lru_.back()));
+  }
+}
+
+void HeaderCache::erase(std::unordered_map<core::MediaId, Slot>::iterator it) {
+  used_bytes_ -= it->second.entry->bytes();
+  lru_.erase(it->second.position);
+  entries_.erase(it);
+}
+
+} // namespace venturi::adapters
@@ -0,0 +1,74 @@
+#pragma once
+#include "../../core/entities/MediaInfo.hpp"
+#include "FileHandle.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace venturi::adapters {
+
+// Size-bounded, in-memory copy of the first and last bytes of media files.
+//
+// Players open every title by fetching the container header (ftyp/moov,
+// EBML/SeekHead) and often the trailer; keeping those regions in RAM turns
+// the cold seeks that dominate time-to-first-frame into sends from memory.
+// Entries are keyed by MediaInfo::id, evicted LRU-first once the budget is
+// exceeded, and ignored as soon as the file's modified_at changes.
+class HeaderCache {
+public:
+  struct Entry {
+    std::chrono::system_clock::time_point modified_at;
+    uint64_t file_size{ 0 };
+
+    std::vector<char> head;   // [0, head.size())
+    std::vector<char> tail;   // [file_size - tail.size(), file_size)
+
+    uint64_t tail_offset() const { return file_size - tail.size(); }
+    std::size_t bytes() const { return head.size() + tail.size(); }
+  };
+
+  HeaderCache(
+    uint64_t    budget_bytes,
+    std::size_t head_bytes,
+    std::size_t tail_bytes
+  );
+
+  // Returns the entry for `media`, or nullptr if absent or stale.
+  std::shared_ptr<const Entry> find(const core::MediaInfo& media);
+
+  // Reads the head and tail of `media` from disk and inserts them.
+  // Blocking; run it off the I/O threads.
+  bool load(const core::MediaInfo& media);
+
+  void invalidate(core::MediaId id);
+
+  bool enabled() const { return budget_bytes_ > 0; }
+
+private:
+  using LruList = std::list<core::MediaId>;
+
+  struct Slot {
+    std::shared_ptr<const Entry> entry;
+    LruList::iterator position;
+  };
+
+  void insert(core::MediaId id, std::shared_ptr<const Entry> entry);
+  void erase(std::unordered_map<core::MediaId, Slot>::iterator it);
+
+  const uint64_t budget_bytes_;
+  const std::size_t head_bytes_;
+  const std::size_t tail_bytes_;
+
+  std::mutex mutex_;
+  LruList lru_;   // most recently used at the front
+  std::unordered_map<core::MediaId, Slot> entries_;
+  uint64_t used_bytes_{ 0 };
+};
+
+} // namespace venturi::adapters
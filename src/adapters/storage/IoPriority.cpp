@@ -0,0 +1,52 @@
+#include "IoPriority.hpp"
+#include "../../../app/Logger.hpp"
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace venturi::adapters {
+
+#if defined(__linux__)
+
+namespace {
+
+// From linux/ioprio.h, which glibc does not wrap.
+constexpr int ioprio_who_process{ 1 };
+constexpr int ioprio_class_shift{ 13 };
+constexpr int ioprio_class_best_effort{ 2 };
+constexpr int ioprio_class_idle{ 3 };
+
+int ioprio_value(int io_class, int level) {
+  return (io_class << ioprio_class_shift) | level;
+}
+
+} // namespace
+
+void make_current_thread_background() {
+  const pid_t tid{ static_cast<pid_t>(::syscall(SYS_gettid)) };
+
+  // On Linux niceness is per thread when addressed by tid.
+  if (::setpriority(PRIO_PROCESS, static_cast<id_t>(tid), 19) != 0) {
+    LOG_DEBUG("setpriority failed: ", std::strerror(errno));
+  }
+
+  // The idle class can be refused (e.g. without CAP_SYS_ADMIN on older
+  // kernels); the lowest best-effort level is the next best thing.
+  if (::syscall(SYS_ioprio_set, ioprio_who_process, tid, ioprio_value(ioprio_class_idle, 0)) != 0 &&
+      ::syscall(SYS_ioprio_set, ioprio_who_process, tid, ioprio_value(ioprio_class_best_effort, 7)) != 0) {
+    LOG_DEBUG("ioprio_set failed: ", std::strerror(errno));
+  }
+}
+
+#else
+
+void make_current_thread_background() {}
+
+#endif
+
+} // namespace venturi::adapters
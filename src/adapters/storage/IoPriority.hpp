@@ -0,0 +1,10 @@
+#pragma once
+
+namespace venturi::adapters {
+
+// Demotes the calling thread to background work: lowest CPU niceness and
+// the idle I/O scheduling class, so foreground streams keep their share of
+// CPU and disk while it runs. Best effort; a no-op off Linux.
+void make_current_thread_background();
+
+} // namespace venturi::adapters
@@ -0,0 +1,270 @@
+#include "LibraryWatcher.hpp"
+#include "IoPriority.hpp"
+#include "../../../app/Logger.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace venturi::adapters {
+
+namespace {
+
+#if defined(__linux__)
+
+constexpr uint32_t directory_mask{
+  IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+  IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_ONLYDIR | IN_DONT_FOLLOW
+};
+
+constexpr std::size_t event_buffer_size{ 64 * 1024 };
+
+#endif
+
+} // namespace
+
+LibraryWatcher::LibraryWatcher(
+  std::shared_ptr<FileSystemRepository>  repository,
+  std::filesystem::path                  root,
+  Options                                options
+) : repository_(std::move(repository)),
+  root_(std::move(root)),
+  options_(std::move(options))
+{}
+
+LibraryWatcher::~LibraryWatcher() {
+  this->stop();
+}
+
+#if defined(__linux__)
+
+bool LibraryWatcher::start() {
+  inotify_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotify_fd_ < 0) {
+    LOG_WARN("Library watcher disabled: inotify_init1: ", std::strerror(errno));
+    return false;
+  }
+
+  wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (wake_fd_ < 0) {
+    LOG_WARN("Library watcher disabled: eventfd: ", std::strerror(errno));
+    this->stop();
+    return false;
+  }
+
+  this->add_watches(root_);
+  if (watches_.empty()) {
+    LOG_WARN("Library watcher disabled: cannot watch ", root_.string());
+    this->stop();
+    return false;
+  }
+
+  LOG_INFO("Watching ", watches_.size(), " directories under ", root_.string());
+  thread_ = std::thread([this] { this->run(); });
+  return true;
+}
+
+void LibraryWatcher::stop() {
+  if (thread_.joinable()) {
+    uint64_t one{ 1 };
+    [[maybe_unused]] auto written = ::write(wake_fd_, &one, sizeof(one));
+    thread_.join();
+  }
+
+  if (inotify_fd_ >= 0) {
+    ::close(inotify_fd_);
+    inotify_fd_ = -1;
+  }
+  if (wake_fd_ >= 0) {
+    ::close(wake_fd_);
+    wake_fd_ = -1;
+  }
+  watches_.clear();
+  pending_.clear();
+}
+
+void LibraryWatcher::run() {
+  // Indexing is background work; playback comes first.
+  make_current_thread_background();
+
+  auto buffer = std::make_unique<char[]>(event_buffer_size);
+
+  while (true) {
+    int timeout{ -1 };
+    if (!pending_.empty()) {
+      auto next = std::min_element(pending_.begin(), pending_.end(),
+        [](const auto& a, const auto& b) { return a.second < b.second; })->second;
+      auto wait = std::chrono::ceil<std::chrono::milliseconds>(next - Clock::now());
+      timeout = static_cast<int>(std::max<std::chrono::milliseconds::rep>(wait.count(), 0));
+    }
+
+    pollfd fds[2]{
+      { inotify_fd_, POLLIN, 0 },
+      { wake_fd_, POLLIN, 0 },
+    };
+    if (::poll(fds, 2, timeout) < 0 && errno != EINTR) {
+      LOG_ERROR("Library watcher stopped: poll: ", std::strerror(errno));
+      return;
+    }
+
+    if (fds[1].revents & POLLIN) {
+      return;
+    }
+
+    if (fds[0].revents & POLLIN) {
+      while (true) {
+        ssize_t bytes = ::read(inotify_fd_, buffer.get(), event_buffer_size);
+        if (bytes <= 0) {
+          break;
+        }
+        this->handle_events(buffer.get(), static_cast<std::size_t>(bytes));
+      }
+    }
+
+    this->settle(Clock::now());
+  }
+}
+
+void LibraryWatcher::handle_events(const char* data, std::size_t size) {
+  auto settles_at = Clock::now() + options_.debounce;
+
+  for (std::size_t offset{ 0 }; offset < size;) {
+    const auto* event = reinterpret_cast<const inotify_event*>(data + offset);
+    offset += sizeof(inotify_event) + event->len;
+
+    if (event->mask & IN_Q_OVERFLOW) {
+      LOG_WARN("Library watcher lost events; rescanning ", root_.string());
+      pending_.clear();
+      this->add_watches(root_);
+      if (options_.on_overflow) {
+        options_.on_overflow();
+      }
+      continue;
+    }
+
+    if (event->mask & IN_IGNORED) {
+      watches_.erase(event->wd);
+      continue;
+    }
+
+    auto watch = watches_.find(event->wd);
+    if (watch == watches_.end() || event->len == 0) {
+      continue;
+    }
+
+    auto path = watch->second / event->name;
+
+    if (event->mask & IN_ISDIR) {
+      if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+        // Files may have landed before the watch did; scan to catch them.
+        this->add_watches(path);
+        if (options_.on_new_directory) {
+          LOG_DEBUG("New directory ", path.string());
+          options_.on_new_directory(path);
+        } else {
+          size_t count = repository_->scan_directory(path, {});
+          LOG_INFO("New directory ", path.string(), ": ", count, " media files");
+        }
+      } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+        this->forget_watches(path);
+        size_t count = repository_->remove_under(path);
+        if (count > 0) {
+          LOG_INFO("Directory ", path.string(), " gone: removed ", count, " media files");
+        }
+      }
+      continue;
+    }
+
+    if (FileSystemRepository::is_video_name(event->name)) {
+      pending_.insert_or_assign(std::move(path), settles_at);
+    }
+  }
+}
+
+void LibraryWatcher::add_watches(const std::filesystem::path& directory) {
+  auto add = [this](const std::filesystem::path& path) {
+    int wd = ::inotify_add_watch(inotify_fd_, path.c_str(), directory_mask);
+    if (wd >= 0) {
+      watches_.insert_or_assign(wd, path);
+      return;
+    }
+    if (errno == ENOSPC && !watch_limit_warned_) {
+      watch_limit_warned_ = true;
+      LOG_WARN("Out of inotify watches; raise fs.inotify.max_user_watches. "
+               "Changes below ", path.string(), " will be missed");
+    }
+  };
+
+  add(directory);
+
+  std::error_code ec;
+  std::filesystem::recursive_directory_iterator it(
+    directory, std::filesystem::directory_options::skip_permission_denied, ec);
+  for (std::filesystem::recursive_directory_iterator end; !ec && it != end; it.increment(ec)) {
+    std::error_code type_ec;
+    if (it->is_directory(type_ec) && !it->is_symlink(type_ec)) {
+      add(it->path());
+    }
+  }
+}
+
+void LibraryWatcher::forget_watches(const std::filesystem::path& directory) {
+  for (auto it = watches_.begin(); it != watches_.end();) {
+    if (is_under(it->second, directory)) {
+      // Already gone if the directory was deleted; harmless then.
+      ::inotify_rm_watch(inotify_fd_, it->first);
+      it = watches_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+#else
+
+bool LibraryWatcher::start() {
+  LOG_WARN("Library watcher is only available on Linux");
+  return false;
+}
+
+void LibraryWatcher::stop() {}
+
+void LibraryWatcher::run() {}
+
+void LibraryWatcher::handle_events(const char*, std::size_t) {}
+
+void LibraryWatcher::add_watches(const std::filesystem::path&) {}
+
+void LibraryWatcher::forget_watches(const std::filesystem::path&) {}
+
+#endif
+
+void LibraryWatcher::settle(Clock::time_point now) {
+  // Everything due goes in as one catalog update.
+  std::vector<std::filesystem::path> due;
+  for (auto it = pending_.begin(); it != pending_.end();) {
+    if (it->second > now) {
+      ++it;
+      continue;
+    }
+
+    auto node = pending_.extract(it++);
+    due.push_back(std::move(node.key()));
+  }
+
+  if (!due.empty() && repository_->refresh(due)) {
+    LOG_DEBUG("Library change: ", due.size(), " files");
+    if (options_.on_change) {
+      options_.on_change();
+    }
+  }
+}
+
+} // namespace venturi::adapters
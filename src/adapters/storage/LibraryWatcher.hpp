@@ -0,0 +1,82 @@
+#pragma once
+#include "FileSystemRepository.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+namespace venturi::adapters {
+
+// Keeps the catalog in step with a media directory without rescanning it.
+//
+// Every directory under the root gets an inotify watch. File events are
+// debounced per path: a file is looked at only after it has been quiet for
+// `debounce`, so a copy in progress is indexed once, when it is complete.
+// The file is then re-stat'ed and added, updated or dropped to match the
+// disk. New directories are watched at once and handed to
+// `on_new_directory` to be scanned off the event thread, which must keep
+// draining the queue during bulk copies; removed ones are dropped from the
+// catalog wholesale.
+//
+// When the kernel queue overflows, events are lost and `on_overflow` is
+// called to arrange a full rescan. Scans only touch entries that changed and
+// prune files that vanished, so this costs a walk of the tree rather than a
+// rebuild. Between events the thread sleeps in poll(2).
+//
+// Linux only; start() fails elsewhere.
+class LibraryWatcher {
+public:
+  struct Options {
+    std::chrono::milliseconds debounce{ 2000 };
+    std::function<void()> on_overflow;
+    std::function<void()> on_change;   // after changed files are refreshed
+
+    // Arranges a scan of a directory created or moved into the tree. When
+    // unset it is scanned on the event thread.
+    std::function<void(const std::filesystem::path&)> on_new_directory;
+  };
+
+  LibraryWatcher(
+    std::shared_ptr<FileSystemRepository>  repository,
+    std::filesystem::path                  root,
+    Options                                options
+  );
+  ~LibraryWatcher();
+
+  LibraryWatcher(const LibraryWatcher&) = delete;
+  LibraryWatcher& operator=(const LibraryWatcher&) = delete;
+
+  // Watches the tree and starts the event thread. Returns false if the
+  // root cannot be watched.
+  bool start();
+  void stop();
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  void run();
+  void handle_events(const char* data, std::size_t size);
+  void add_watches(const std::filesystem::path& directory);
+  void forget_watches(const std::filesystem::path& directory);
+  void settle(Clock::time_point now);
+
+  std::shared_ptr<FileSystemRepository> repository_;
+  std::filesystem::path root_;
+  Options options_;
+
+  int inotify_fd_{ -1 };
+  int wake_fd_{ -1 };
+  bool watch_limit_warned_{ false };
+
+  // Owned by the event thread once it runs.
+  std::unordered_map<int, std::filesystem::path> watches_;
+  std::map<std::filesystem::path, Clock::time_point> pending_;   // file -> settles at
+
+  std::thread thread_;
+};
+
+} // namespace venturi::adapters
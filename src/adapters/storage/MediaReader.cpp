@@ -0,0 +1,140 @@
+#include "MediaReader.hpp"
+
+#include <boost/asio/post.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace venturi::adapters {
+
+MediaReader::MediaReader(const Config& config)
+  : config_(config)
+  , disk_pool_(std::max<uint32_t>(config.disk_threads, 1))
+  , header_cache_(
+      config.header_cache_budget,
+      config.header_cache_head_bytes,
+      config.header_cache_tail_bytes
+    )
+  , seek_index_cache_(config.seek_index_cache_budget)
+  , block_cache_(
+      disk_pool_,
+      config.block_cache_budget,
+      config.block_cache_block_size
+    )
+  , buffer_pool_(
+      config.direct_io_enabled ? config.direct_io_buffer_size : 0,
+      config.direct_io_enabled ? config.direct_io_buffer_count : 0
+    )
+{}
+
+MediaReader::~MediaReader() {
+  disk_pool_.join();
+}
+
+void MediaReader::prefetch_headers(const core::MediaInfo& media) {
+  if (!header_cache_.enabled()) {
+    return;
+  }
+
+  {
+    std::lock_guard lock(loading_mutex_);
+    if (!loading_.insert(media.id).second) {
+      return;
+    }
+  }
+
+  asio::post(disk_pool_, [this, media] {
+    if (!header_cache_.find(media)) {
+      header_cache_.load(media);
+    }
+
+    std::lock_guard lock(loading_mutex_);
+    loading_.erase(media.id);
+  });
+}
+
+void MediaReader::warm_headers(const core::MediaList& media) {
+  for (const auto& info : media) {
+    this->prefetch_headers(info);
+  }
+}
+
+std::shared_ptr<const void> MediaReader::track_stream(core::MediaId media_id) {
+  {
+    std::lock_guard lock(streams_mutex_);
+    ++active_streams_[media_id];
+  }
+
+  return std::shared_ptr<const void>(nullptr, [this, media_id](const void*) {
+    std::lock_guard lock(streams_mutex_);
+    if (auto it = active_streams_.find(media_id); it != active_streams_.end() && --it->second == 0) {
+      active_streams_.erase(it);
+    }
+  });
+}
+
+uint32_t MediaReader::active_streams(core::MediaId media_id) {
+  std::lock_guard lock(streams_mutex_);
+  auto it = active_streams_.find(media_id);
+  return it == active_streams_.end() ? 0 : it->second;
+}
+
+bool MediaReader::prefer_block_cache(core::MediaId media_id) {
+  if (!block_cache_.enabled()) {
+    return false;
+  }
+
+  return this->active_streams(media_id) >= config_.block_cache_min_readers;
+}
+
+double MediaReader::decayed_plays(
+  PlayHistory&                            history,
+  std::chrono::steady_clock::time_point   now
+) const {
+  // Halve the count for every hour since it was last touched.
+  const double hours{ std::chrono::duration<double, std::ratio<3600>>(now - history.updated).count() };
+  history.plays *= std::exp2(-hours);
+  history.updated = now;
+  return history.plays;
+}
+
+void MediaReader::record_play(core::MediaId media_id) {
+  const auto now{ std::chrono::steady_clock::now() };
+
+  std::lock_guard lock(streams_mutex_);
+  auto [it, inserted] = play_history_.try_emplace(media_id, PlayHistory{ 0.0, now });
+  this->decayed_plays(it->second, now);
+  it->second.plays += 1.0;
+
+  // Forget titles whose history has decayed to nothing.
+  if (play_history_.size() > 4096) {
+    for (auto entry = play_history_.begin(); entry != play_history_.end();) {
+      if (this->decayed_plays(entry->second, now) < 0.05) {
+        entry = play_history_.erase(entry);
+      } else {
+        ++entry;
+      }
+    }
+  }
+}
+
+bool MediaReader::prefer_direct_io(core::MediaId media_id, uint64_t file_size) {
+  if (!config_.direct_io_enabled || file_size < config_.direct_io_min_file_size) {
+    return false;
+  }
+
+  std::lock_guard lock(streams_mutex_);
+
+  // Someone else streaming it means its pages are worth keeping.
+  if (auto it = active_streams_.find(media_id); it != active_streams_.end() && it->second > 1) {
+    return false;
+  }
+
+  double plays{ 0.0 };
+  if (auto it = play_history_.find(media_id); it != play_history_.end()) {
+    plays = this->decayed_plays(it->second, std::chrono::steady_clock::now());
+  }
+
+  return plays <= config_.direct_io_max_recent_plays;
+}
+
+} // namespace venturi::adapters
@@ -0,0 +1,85 @@
+#pragma once
+#include "../../core/entities/MediaInfo.hpp"
+#include "../../core/entities/MediaList.hpp"
+#include "../../../app/Config.hpp"
+#include "HeaderCache.hpp"
+#include "SeekIndexCache.hpp"
+#include "BlockCache.hpp"
+#include "AlignedBufferPool.hpp"
+
+#include <boost/asio/thread_pool.hpp>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace venturi::adapters {
+
+namespace asio = boost::asio;
+
+// The media read path shared by every HTTP session: caches and the pool of
+// threads that perform blocking disk work on their behalf.
+class MediaReader {
+public:
+  explicit MediaReader(const Config& config);
+  ~MediaReader();
+
+  HeaderCache& header_cache() { return header_cache_; }
+  SeekIndexCache& seek_index_cache() { return seek_index_cache_; }
+  BlockCache& block_cache() { return block_cache_; }
+  AlignedBufferPool& buffer_pool() { return buffer_pool_; }
+
+  // Registers an active stream of `media_id` for as long as the returned
+  // token is alive.
+  std::shared_ptr<const void> track_stream(core::MediaId media_id);
+
+  uint32_t active_streams(core::MediaId media_id);
+
+  // True when enough sessions read `media_id` that going through the
+  // shared block cache beats independent sendfile reads.
+  bool prefer_block_cache(core::MediaId media_id);
+
+  // Counts a new play of `media_id` for the access-frequency heuristic.
+  void record_play(core::MediaId media_id);
+
+  // True when `media_id` is large and cold enough that streaming it should
+  // bypass the page cache instead of evicting hotter titles.
+  bool prefer_direct_io(core::MediaId media_id, uint64_t file_size);
+
+  // Caches the head and tail of `media` in the background, unless they are
+  // already cached or being loaded.
+  void prefetch_headers(const core::MediaInfo& media);
+
+  // Queues prefetch_headers() for every entry, e.g. right after a scan.
+  void warm_headers(const core::MediaList& media);
+
+  asio::thread_pool& disk_pool() { return disk_pool_; }
+
+private:
+  const Config& config_;
+  asio::thread_pool disk_pool_;
+  HeaderCache header_cache_;
+  SeekIndexCache seek_index_cache_;
+  BlockCache block_cache_;
+
+  AlignedBufferPool buffer_pool_;
+
+  struct PlayHistory {
+    double plays{ 0.0 };
+    std::chrono::steady_clock::time_point updated;
+  };
+
+  double decayed_plays(PlayHistory& history, std::chrono::steady_clock::time_point now) const;
+
+  std::mutex streams_mutex_;
+  std::unordered_map<core::MediaId, uint32_t> active_streams_;
+  std::unordered_map<core::MediaId, PlayHistory> play_history_;
+
+  std::mutex loading_mutex_;
+  std::unordered_set<core::MediaId> loading_;
+};
+
+} // namespace venturi::adapters
@@ -0,0 +1,284 @@
+#include "ParallelScanner.hpp"
+#include "../../../app/Logger.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace venturi::adapters {
+
+namespace {
+
+// Idle threads re-check for stealable work at least this often.
+constexpr std::chrono::milliseconds idle_poll{ 2 };
+
+#if defined(__linux__)
+
+// glibc exposes getdents64() only from 2.30; the raw record is stable.
+struct LinuxDirent64 {
+  uint64_t d_ino;
+  int64_t d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[];
+};
+
+constexpr std::size_t dirent_buffer_size{ 64 * 1024 };
+
+FileHandle::Status to_status(const struct statx& stx) {
+  FileHandle::Status status;
+  status.size = stx.stx_size;
+  status.inode = stx.stx_ino;
+  status.modified_at = std::chrono::system_clock::time_point{
+    std::chrono::duration_cast<std::chrono::system_clock::duration>(
+      std::chrono::seconds{ stx.stx_mtime.tv_sec } + std::chrono::nanoseconds{ stx.stx_mtime.tv_nsec }
+    )
+  };
+  return status;
+}
+
+#endif
+
+} // namespace
+
+struct ParallelScanner::Worker {
+  std::size_t index{ 0 };   // own queue
+  std::vector<Entry> batch;
+#if defined(__linux__)
+  std::unique_ptr<char[]> dirent_buffer{ std::make_unique<char[]>(dirent_buffer_size) };
+#endif
+};
+
+ParallelScanner::ParallelScanner(Options options)
+  : options_(options)
+{
+  options_.threads = std::max<std::size_t>(options_.threads, 1);
+  options_.batch_size = std::max<std::size_t>(options_.batch_size, 1);
+}
+
+std::size_t ParallelScanner::scan(
+  const std::filesystem::path&  root,
+  const Filter&                 filter,
+  const BatchHandler&           on_batch,
+  const core::ScanHooks&        hooks
+) {
+  filter_ = &filter;
+  on_batch_ = &on_batch;
+  found_ = 0;
+  pending_ = 0;
+
+  queues_.clear();
+  for (std::size_t i{ 0 }; i < options_.threads; ++i) {
+    queues_.push_back(std::make_unique<WorkQueue>());
+  }
+  this->push_directory(0, root);
+
+  // New threads inherit the caller's CPU and I/O priority, so a scan
+  // started from a background job stays in the background.
+  {
+    std::vector<std::jthread> threads;
+    threads.reserve(options_.threads);
+    for (std::size_t i{ 0 }; i < options_.threads; ++i) {
+      threads.emplace_back([this, i, &hooks] { this->run_worker(i, hooks); });
+    }
+  }
+
+  queues_.clear();
+  return found_.load();
+}
+
+void ParallelScanner::run_worker(std::size_t index, const core::ScanHooks& hooks) {
+  Worker worker;
+  worker.index = index;
+  std::filesystem::path directory;
+
+  while (true) {
+    if (!this->next_directory(index, directory)) {
+      if (pending_.load(std::memory_order_acquire) == 0) {
+        break;
+      }
+
+      std::unique_lock lock(idle_mutex_);
+      idle_.wait_for(lock, idle_poll);
+      continue;
+    }
+
+    // After a stop, directories are drained without being read.
+    if (!hooks.stop_token.stop_requested()) {
+      if (hooks.on_directory) {
+        hooks.on_directory(directory);
+      }
+      this->read_directory(worker, directory);
+    }
+
+    if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      idle_.notify_all();
+    }
+  }
+
+  this->flush(worker);
+}
+
+bool ParallelScanner::next_directory(std::size_t index, std::filesystem::path& directory) {
+  // Own work from the back: depth first, and likely still in cache.
+  {
+    auto& own{ *queues_[index] };
+    std::lock_guard lock(own.mutex);
+    if (!own.directories.empty()) {
+      directory = std::move(own.directories.back());
+      own.directories.pop_back();
+      return true;
+    }
+  }
+
+  // Steal from the front of someone else's: the oldest, shallowest
+  // directory, which tends to carry the largest subtree.
+  for (std::size_t offset{ 1 }; offset < queues_.size(); ++offset) {
+    auto& victim{ *queues_[(index + offset) % queues_.size()] };
+    std::lock_guard lock(victim.mutex);
+    if (!victim.directories.empty()) {
+      directory = std::move(victim.directories.front());
+      victim.directories.pop_front();
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void ParallelScanner::push_directory(std::size_t index, std::filesystem::path directory) {
+  pending_.fetch_add(1, std::memory_order_acq_rel);
+  {
+    auto& own{ *queues_[index] };
+    std::lock_guard lock(own.mutex);
+    own.directories.push_back(std::move(directory));
+  }
+  idle_.notify_one();
+}
+
+#if defined(__linux__)
+
+void ParallelScanner::read_directory(Worker& worker, const std::filesystem::path& directory) {
+  int dir_fd{ ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC) };
+  if (dir_fd < 0) {
+    LOG_WARN("Error scanning directory: ", directory.string(), ": ", std::strerror(errno));
+    return;
+  }
+
+  FileHandle dir{ dir_fd };
+
+  constexpr unsigned int statx_mask{ STATX_TYPE | STATX_SIZE | STATX_INO | STATX_MTIME };
+
+  while (true) {
+    long bytes{ ::syscall(SYS_getdents64, dir_fd, worker.dirent_buffer.get(), dirent_buffer_size) };
+    if (bytes < 0) {
+      if (errno == EINTR) continue;
+      LOG_WARN("Error scanning directory: ", directory.string(), ": ", std::strerror(errno));
+      return;
+    }
+    if (bytes == 0) {
+      return;
+    }
+
+    for (long offset{ 0 }; offset < bytes;) {
+      auto* entry{ reinterpret_cast<LinuxDirent64*>(worker.dirent_buffer.get() + offset) };
+      offset += entry->d_reclen;
+
+      std::string_view name{ entry->d_name };
+      if (name == "." || name == "..") {
+        continue;
+      }
+
+      unsigned char type{ entry->d_type };
+
+      // Some filesystems (older XFS, many network ones) report no type.
+      struct statx stx{};
+      bool have_stat{ false };
+      if (type == DT_UNKNOWN) {
+        if (::statx(dir_fd, entry->d_name, AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT, statx_mask, &stx) != 0) {
+          continue;
+        }
+        type = S_ISDIR(stx.stx_mode) ? DT_DIR : S_ISLNK(stx.stx_mode) ? DT_LNK : S_ISREG(stx.stx_mode) ? DT_REG : DT_UNKNOWN;
+        have_stat = type == DT_REG;
+      }
+
+      if (type == DT_DIR) {
+        this->push_directory(worker.index, directory / name);
+        continue;
+      }
+      if ((type != DT_REG && type != DT_LNK) || !(*filter_)(name)) {
+        continue;
+      }
+
+      // Regular files, or links that resolve to one.
+      if (!have_stat) {
+        if (::statx(dir_fd, entry->d_name, AT_NO_AUTOMOUNT, statx_mask, &stx) != 0 || !S_ISREG(stx.stx_mode)) {
+          continue;
+        }
+      }
+
+      // Joined by hand: `directory / name` would parse the result.
+      std::string path{ directory.native() };
+      if (!path.ends_with('/')) {
+        path += '/';
+      }
+      path += name;
+      this->add_entry(worker, std::move(path), to_status(stx));
+    }
+  }
+}
+
+#else
+
+void ParallelScanner::read_directory(Worker& worker, const std::filesystem::path& directory) {
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+    if (entry.is_directory(ec) && !entry.is_symlink(ec)) {
+      this->push_directory(worker.index, entry.path());
+      continue;
+    }
+    if (!entry.is_regular_file(ec) || !(*filter_)(entry.path().filename().native())) {
+      continue;
+    }
+
+    auto status{ FileHandle::stat(entry.path(), ec) };
+    if (!ec) {
+      this->add_entry(worker, entry.path().string(), status);
+    }
+  }
+
+  if (ec) {
+    LOG_WARN("Error scanning directory: ", directory.string(), ": ", ec.message());
+  }
+}
+
+#endif
+
+void ParallelScanner::add_entry(Worker& worker, std::string path, const FileHandle::Status& status) {
+  worker.batch.push_back({ std::move(path), status });
+  if (worker.batch.size() >= options_.batch_size) {
+    this->flush(worker);
+  }
+}
+
+void ParallelScanner::flush(Worker& worker) {
+  if (worker.batch.empty()) {
+    return;
+  }
+
+  found_.fetch_add(worker.batch.size(), std::memory_order_relaxed);
+  (*on_batch_)(std::move(worker.batch));
+  worker.batch.clear();
+}
+
+} // namespace venturi::adapters
@@ -0,0 +1,86 @@
+#pragma once
+#include "../../core/ports/MediaRepository.hpp"
+#include "FileHandle.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace venturi::adapters {
+
+// Walks a directory tree on several threads at once. Each thread owns a
+// deque of directories, working depth-first from its back while idle
+// threads steal from the front of others', so one deep subtree cannot
+// leave the rest of the pool waiting. On Linux directories are read with
+// getdents64(2) and files stat'ed with statx(2) relative to the open
+// directory, which skips path resolution and, for most filesystems,
+// learns each entry's type without a stat at all.
+//
+// Symbolic links to files are followed; links to directories are not,
+// matching std::filesystem::recursive_directory_iterator.
+class ParallelScanner {
+public:
+  struct Entry {
+    std::string path;
+    FileHandle::Status status;
+  };
+
+  // Chooses which regular files to report, by file name.
+  using Filter = std::function<bool(std::string_view name)>;
+
+  // Receives matching files in batches. Called concurrently from the scan
+  // threads.
+  using BatchHandler = std::function<void(std::vector<Entry>&& batch)>;
+
+  struct Options {
+    std::size_t threads{ 8 };
+    std::size_t batch_size{ 512 };
+  };
+
+  explicit ParallelScanner(Options options);
+
+  // Blocks until the walk of `root` finishes or `hooks.stop_token` fires.
+  // `hooks.on_directory` is called concurrently; `hooks.on_found` is left
+  // to `on_batch`. Returns the number of entries handed to `on_batch`.
+  std::size_t scan(
+    const std::filesystem::path&  root,
+    const Filter&                 filter,
+    const BatchHandler&           on_batch,
+    const core::ScanHooks&        hooks
+  );
+
+private:
+  struct WorkQueue {
+    std::mutex mutex;
+    std::deque<std::filesystem::path> directories;
+  };
+
+  struct Worker;
+
+  void run_worker(std::size_t index, const core::ScanHooks& hooks);
+  bool next_directory(std::size_t index, std::filesystem::path& directory);
+  void push_directory(std::size_t index, std::filesystem::path directory);
+  void read_directory(Worker& worker, const std::filesystem::path& directory);
+  void add_entry(Worker& worker, std::string path, const FileHandle::Status& status);
+  void flush(Worker& worker);
+
+  Options options_;
+
+  // State of the scan in progress.
+  std::vector<std::unique_ptr<WorkQueue>> queues_;
+  std::atomic<std::size_t> pending_{ 0 };   // queued or being read
+  std::atomic<std::size_t> found_{ 0 };
+  std::mutex idle_mutex_;
+  std::condition_variable idle_;
+  const Filter* filter_{ nullptr };
+  const BatchHandler* on_batch_{ nullptr };
+};
+
+} // namespace venturi::adapters
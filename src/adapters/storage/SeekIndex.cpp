@@ -0,0 +1,665 @@
+#include "SeekIndex.hpp"
+#include "../../../app/Logger.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <span>
+
+namespace venturi::adapters {
+
+namespace {
+
+using Bytes = std::span<const unsigned char>;
+using Point = SeekIndex::Point;
+
+// Files whose index lists every sample as a keyframe (audio-only, intra
+// codecs) keep one point per this many milliseconds.
+constexpr uint32_t min_point_spacing_ms{ 500 };
+
+// A decoded index is never allowed to outgrow the source it may be read
+// from (12 bytes per stored point), nor a sample walk to visit more
+// samples than a source of that size could list sizes for.
+constexpr std::size_t max_points{ SeekIndex::max_source_bytes / 12 };
+constexpr uint64_t max_walked_samples{ SeekIndex::max_source_bytes / 4 };
+
+uint64_t read_be(const unsigned char* p, std::size_t bytes) {
+  uint64_t value{ 0 };
+  for (std::size_t i{ 0 }; i < bytes; ++i) {
+    value = (value << 8) | p[i];
+  }
+  return value;
+}
+
+uint32_t be32(const unsigned char* p) {
+  return static_cast<uint32_t>(read_be(p, 4));
+}
+
+// value * multiplier / divisor in milliseconds, saturating.
+uint32_t to_ms(uint64_t value, uint64_t multiplier, uint64_t divisor) {
+  auto ms{ static_cast<unsigned __int128>(value) * multiplier / divisor };
+  return static_cast<uint32_t>(std::min<unsigned __int128>(ms, std::numeric_limits<uint32_t>::max()));
+}
+
+// --- MP4 ---
+
+constexpr uint32_t fourcc(const char (&name)[5]) {
+  return static_cast<uint32_t>(name[0]) << 24 | static_cast<uint32_t>(name[1]) << 16
+    | static_cast<uint32_t>(name[2]) << 8 | static_cast<uint32_t>(name[3]);
+}
+
+// Calls `visit(type, payload)` for each box in `parent` until it returns
+// false or a box header does not fit.
+template <typename Visit>
+void for_each_box(Bytes parent, Visit&& visit) {
+  while (parent.size() >= 8) {
+    uint64_t size{ be32(parent.data()) };
+    uint32_t type{ be32(parent.data() + 4) };
+    std::size_t header{ 8 };
+
+    if (size == 1) {
+      if (parent.size() < 16) return;
+      size = read_be(parent.data() + 8, 8);
+      header = 16;
+    } else if (size == 0) {
+      size = parent.size();
+    }
+
+    if (size < header || size > parent.size()) return;
+    if (!visit(type, parent.subspan(header, size - header))) return;
+    parent = parent.subspan(size);
+  }
+}
+
+std::optional<Bytes> find_box(std::optional<Bytes> parent, uint32_t type) {
+  std::optional<Bytes> found;
+  if (parent) {
+    for_each_box(*parent, [&found, type](uint32_t box_type, Bytes payload) {
+      if (box_type == type) {
+        found = payload;
+      }
+      return !found;
+    });
+  }
+  return found;
+}
+
+// A full box holding a counted table: version/flags, zero or more fixed
+// fields, the entry count, then the entries.
+struct Table {
+  const unsigned char* entries;
+  uint32_t count;
+  std::size_t entry_size;
+
+  const unsigned char* operator[](uint32_t i) const { return entries + i * entry_size; }
+};
+
+std::optional<Table> read_table(std::optional<Bytes> box, std::size_t header, std::size_t entry_size) {
+  if (!box || box->size() < header) {
+    return std::nullopt;
+  }
+  uint32_t count{ be32(box->data() + header - 4) };
+  if ((box->size() - header) / entry_size < count) {
+    return std::nullopt;
+  }
+  return Table{ box->data() + header, count, entry_size };
+}
+
+// The trak box of the first video track, or of the first track when
+// there is no video.
+std::optional<Bytes> seek_track(Bytes moov) {
+  std::optional<Bytes> chosen;
+  for_each_box(moov, [&chosen](uint32_t type, Bytes payload) {
+    if (type != fourcc("trak")) {
+      return true;
+    }
+    auto mdia = find_box(payload, fourcc("mdia"));
+    if (!mdia) {
+      return true;
+    }
+
+    auto hdlr = find_box(mdia, fourcc("hdlr"));
+    bool video{ hdlr && hdlr->size() >= 12 && be32(hdlr->data() + 8) == fourcc("vide") };
+    if (video || !chosen) {
+      chosen = payload;
+    }
+    return !video;
+  });
+  return chosen;
+}
+
+uint64_t track_timescale(std::optional<Bytes> mdia) {
+  auto mdhd = find_box(mdia, fourcc("mdhd"));
+  if (mdhd && mdhd->size() >= 24) {
+    return be32(mdhd->data() + ((*mdhd)[0] == 1 ? 20 : 12));
+  }
+  return 0;
+}
+
+std::vector<Point> mp4_keyframes(Bytes moov) {
+  auto mdia = find_box(seek_track(moov), fourcc("mdia"));
+  uint64_t timescale{ track_timescale(mdia) };
+
+  auto stbl = find_box(find_box(mdia, fourcc("minf")), fourcc("stbl"));
+  auto stts = read_table(find_box(stbl, fourcc("stts")), 8, 8);
+  auto stsc = read_table(find_box(stbl, fourcc("stsc")), 8, 12);
+  auto stss = read_table(find_box(stbl, fourcc("stss")), 8, 4);   // absent: all keyframes
+  auto chunks = read_table(find_box(stbl, fourcc("stco")), 8, 4);
+  if (!chunks) {
+    chunks = read_table(find_box(stbl, fourcc("co64")), 8, 8);
+  }
+  auto stsz = find_box(stbl, fourcc("stsz"));
+
+  if (timescale == 0 || !stts || !stsc || stsc->count == 0 || !chunks || !stsz || stsz->size() < 12) {
+    return {};
+  }
+
+  uint32_t fixed_size{ be32(stsz->data() + 4) };
+  uint64_t sample_count{ be32(stsz->data() + 8) };
+  if (fixed_size == 0 && (stsz->size() - 12) / 4 < sample_count) {
+    return {};
+  }
+
+  // A fixed-size stsz states its count without listing anything; stts
+  // must account for every sample too.
+  uint64_t timed_samples{ 0 };
+  for (uint32_t i{ 0 }; i < stts->count; ++i) {
+    timed_samples += be32((*stts)[i]);
+  }
+  sample_count = std::min(sample_count, timed_samples);
+  if (sample_count > max_walked_samples) {
+    return {};
+  }
+  const unsigned char* sizes{ stsz->data() + 12 };
+
+  std::vector<Point> points;
+  if (stss) {
+    points.reserve(stss->count);
+  }
+
+  // Walk the samples chunk by chunk: stsc says how many each chunk holds,
+  // stsz how far apart they are, stts how long each lasts.
+  uint64_t time{ 0 };
+  uint32_t stts_index{ 0 };
+  uint32_t stts_left{ stts->count > 0 ? be32((*stts)[0]) : 0 };
+  uint32_t stss_index{ 0 };
+  uint32_t stsc_index{ 0 };
+  uint64_t sample{ 1 };
+
+  for (uint32_t chunk{ 1 }; chunk <= chunks->count && sample <= sample_count; ++chunk) {
+    while (stsc_index + 1 < stsc->count && be32((*stsc)[stsc_index + 1]) <= chunk) {
+      ++stsc_index;
+    }
+    uint32_t per_chunk{ be32((*stsc)[stsc_index] + 4) };
+    uint64_t offset{ read_be((*chunks)[chunk - 1], chunks->entry_size) };
+
+    for (uint32_t i{ 0 }; i < per_chunk && sample <= sample_count; ++i, ++sample) {
+      bool keyframe{ true };
+      if (stss) {
+        while (stss_index < stss->count && be32((*stss)[stss_index]) < sample) {
+          ++stss_index;
+        }
+        keyframe = stss_index < stss->count && be32((*stss)[stss_index]) == sample;
+      }
+
+      if (keyframe) {
+        uint32_t time_ms{ to_ms(time, 1000, timescale) };
+        if (stss || points.empty() || time_ms - points.back().time_ms >= min_point_spacing_ms) {
+          if (points.size() == max_points) {
+            return {};
+          }
+          points.push_back({ time_ms, offset });
+        }
+      }
+
+      offset += fixed_size != 0 ? fixed_size : be32(sizes + (sample - 1) * 4);
+
+      while (stts_left == 0 && stts_index + 1 < stts->count) {
+        stts_left = be32((*stts)[++stts_index]);
+      }
+      if (stts_left > 0) {
+        time += be32((*stts)[stts_index] + 4);
+        --stts_left;
+      }
+    }
+  }
+
+  return points;
+}
+
+// --- Fragmented MP4 ---
+
+// Fragments are found by walking the top-level boxes after the moov;
+// these bound the walk.
+constexpr std::size_t max_fragments{ 1 << 20 };
+constexpr uint64_t max_moof_bytes{ 1024 * 1024 };
+
+constexpr uint32_t sample_is_non_sync{ 0x10000 };
+
+// What a fragment needs from the moov about the indexed track.
+struct FragmentTrack {
+  uint32_t id{ 0 };
+  uint64_t timescale{ 0 };
+  uint32_t default_duration{ 0 };   // trex
+  uint32_t default_flags{ 0 };      // trex
+};
+
+std::optional<FragmentTrack> fragment_track(Bytes moov) {
+  auto trak = seek_track(moov);
+  auto tkhd = find_box(trak, fourcc("tkhd"));
+  if (!tkhd || tkhd->size() < 24) {
+    return std::nullopt;
+  }
+
+  FragmentTrack track;
+  track.id = be32(tkhd->data() + ((*tkhd)[0] == 1 ? 20 : 12));
+  track.timescale = track_timescale(find_box(trak, fourcc("mdia")));
+  if (track.timescale == 0) {
+    return std::nullopt;
+  }
+
+  for_each_box(find_box(moov, fourcc("mvex")).value_or(Bytes{}), [&track](uint32_t type, Bytes trex) {
+    if (type == fourcc("trex") && trex.size() >= 24 && be32(trex.data() + 4) == track.id) {
+      track.default_duration = be32(trex.data() + 12);
+      track.default_flags = be32(trex.data() + 20);
+      return false;
+    }
+    return true;
+  });
+  return track;
+}
+
+// The indexed track's run in one moof: its decode time, if the fragment
+// says, how long it lasts and whether it opens on a keyframe.
+struct Fragment {
+  std::optional<uint64_t> start;
+  uint64_t duration{ 0 };
+  bool keyframe{ false };
+  bool found{ false };
+};
+
+Fragment read_fragment(Bytes moof, const FragmentTrack& track) {
+  Fragment fragment;
+  for_each_box(moof, [&fragment, &track](uint32_t type, Bytes traf) {
+    if (type != fourcc("traf")) {
+      return true;
+    }
+
+    auto tfhd = find_box(traf, fourcc("tfhd"));
+    if (!tfhd || tfhd->size() < 8 || be32(tfhd->data() + 4) != track.id) {
+      return true;
+    }
+
+    // tfhd: optional fields follow the track id in flag order.
+    uint32_t tfhd_flags{ be32(tfhd->data()) & 0xFFFFFF };
+    std::size_t at{ 8 };
+    uint32_t default_duration{ track.default_duration };
+    uint32_t default_flags{ track.default_flags };
+    if (tfhd_flags & 0x01) at += 8;
+    if (tfhd_flags & 0x02) at += 4;
+    if (tfhd_flags & 0x08) {
+      if (tfhd->size() < at + 4) return false;
+      default_duration = be32(tfhd->data() + at);
+      at += 4;
+    }
+    if (tfhd_flags & 0x10) at += 4;
+    if (tfhd_flags & 0x20) {
+      if (tfhd->size() < at + 4) return false;
+      default_flags = be32(tfhd->data() + at);
+    }
+
+    if (auto tfdt = find_box(traf, fourcc("tfdt")); tfdt && tfdt->size() >= 8) {
+      bool wide{ (*tfdt)[0] == 1 };
+      if (!wide || tfdt->size() >= 12) {
+        fragment.start = read_be(tfdt->data() + 4, wide ? 8 : 4);
+      }
+    }
+
+    bool first_run{ true };
+    for_each_box(traf, [&](uint32_t run_type, Bytes trun) {
+      if (run_type != fourcc("trun") || trun.size() < 8) {
+        return true;
+      }
+
+      // trun: optional fields, then per-sample entries of the flagged fields.
+      uint32_t flags{ be32(trun.data()) & 0xFFFFFF };
+      uint32_t count{ be32(trun.data() + 4) };
+      std::size_t entries{ 8 };
+      if (flags & 0x001) entries += 4;
+      std::optional<uint32_t> first_flags;
+      if (flags & 0x004) {
+        if (trun.size() < entries + 4) return false;
+        first_flags = be32(trun.data() + entries);
+        entries += 4;
+      }
+
+      const std::size_t entry_size{ 4u * std::popcount(flags & 0xF00) };
+      if (trun.size() < entries || (entry_size > 0 && (trun.size() - entries) / entry_size < count)) {
+        return false;
+      }
+
+      if (first_run && count > 0) {
+        uint32_t sample_flags{ default_flags };
+        if (first_flags) {
+          sample_flags = *first_flags;
+        } else if (flags & 0x400) {
+          sample_flags = be32(trun.data() + entries + 4 * std::popcount(flags & 0x300));
+        }
+        fragment.keyframe = !(sample_flags & sample_is_non_sync);
+      }
+
+      if (flags & 0x100) {
+        for (uint32_t i{ 0 }; i < count; ++i) {
+          fragment.duration += be32(trun.data() + entries + i * entry_size);
+        }
+      } else {
+        fragment.duration += uint64_t{ count } * default_duration;
+      }
+      first_run = false;
+      return true;
+    });
+
+    fragment.found = !first_run;
+    return false;
+  });
+  return fragment;
+}
+
+struct FragmentIndex {
+  std::vector<Point> points;   // fragments that open on a keyframe
+  Point end{ 0, 0 };           // just past the last fragment
+};
+
+// One pread per top-level box, plus one per moof; fragments are usually
+// seconds long, so even a feature-length file is a few thousand reads.
+FragmentIndex mp4_fragments(const FileHandle& file, uint64_t file_size, uint64_t offset, Bytes moov) {
+  FragmentIndex index;
+  auto track = fragment_track(moov);
+  if (!track) {
+    return index;
+  }
+
+  uint64_t time{ 0 };
+  std::size_t fragments{ 0 };
+  std::vector<unsigned char> moof;
+
+  while (offset + 8 <= file_size && fragments < max_fragments) {
+    unsigned char header[16];
+    std::size_t length{ static_cast<std::size_t>(std::min<uint64_t>(sizeof(header), file_size - offset)) };
+    if (!file.read_exact(header, length, offset)) {
+      break;
+    }
+
+    uint64_t size{ be32(header) };
+    uint32_t type{ be32(header + 4) };
+    std::size_t header_size{ 8 };
+    if (size == 1 && length == 16) {
+      size = read_be(header + 8, 8);
+      header_size = 16;
+    } else if (size == 0) {
+      size = file_size - offset;
+    }
+    if (size < header_size || size > file_size - offset) {
+      break;
+    }
+
+    if (type == fourcc("moof")) {
+      if (size > max_moof_bytes) {
+        break;
+      }
+      moof.resize(size - header_size);
+      if (!file.read_exact(moof.data(), moof.size(), offset + header_size)) {
+        break;
+      }
+
+      auto fragment = read_fragment(moof, *track);
+      if (fragment.found) {
+        time = fragment.start.value_or(time);
+        if (fragment.keyframe) {
+          index.points.push_back({ to_ms(time, 1000, track->timescale), offset });
+        }
+        time += fragment.duration;
+        index.end.time_ms = to_ms(time, 1000, track->timescale);
+      }
+      ++fragments;
+    } else if (type == fourcc("mdat") && fragments > 0) {
+      index.end.offset = offset + size;
+    }
+
+    offset += size;
+  }
+
+  return index;
+}
+
+// --- Matroska ---
+
+constexpr uint32_t ebml_id{ 0x1A45DFA3 };
+constexpr uint32_t segment_id{ 0x18538067 };
+constexpr uint32_t info_id{ 0x1549A966 };
+constexpr uint32_t timestamp_scale_id{ 0x2AD7B1 };
+constexpr uint32_t cues_id{ 0x1C53BB6B };
+constexpr uint32_t cue_point_id{ 0xBB };
+constexpr uint32_t cue_time_id{ 0xB3 };
+constexpr uint32_t cue_track_positions_id{ 0xB7 };
+constexpr uint32_t cue_cluster_position_id{ 0xF1 };
+
+// Bytes needed to decode the Segment header and its Info.
+constexpr std::size_t matroska_head_bytes{ 64 * 1024 };
+
+struct ElementHeader {
+  uint32_t id;
+  std::size_t length;   // of the id and size fields
+  uint64_t size;
+  bool unknown_size;
+};
+
+std::optional<ElementHeader> read_header(Bytes bytes) {
+  if (bytes.empty() || bytes[0] == 0) {
+    return std::nullopt;
+  }
+
+  std::size_t id_length{ static_cast<std::size_t>(std::countl_zero(bytes[0])) + 1 };
+  if (id_length > 4 || bytes.size() <= id_length || bytes[id_length] == 0) {
+    return std::nullopt;
+  }
+
+  std::size_t size_length{ static_cast<std::size_t>(std::countl_zero(bytes[id_length])) + 1 };
+  if (size_length > bytes.size() - id_length) {
+    return std::nullopt;
+  }
+
+  uint64_t marker_mask{ 0xFFu >> size_length };
+  uint64_t size{ bytes[id_length] & marker_mask };
+  bool unknown{ size == marker_mask };
+  for (std::size_t i{ 1 }; i < size_length; ++i) {
+    size = (size << 8) | bytes[id_length + i];
+    unknown &= bytes[id_length + i] == 0xFF;
+  }
+
+  return ElementHeader{ static_cast<uint32_t>(read_be(bytes.data(), id_length)), id_length + size_length, size, unknown };
+}
+
+// Calls `visit(id, payload)` for each element in `parent` until it returns
+// false or an element does not fit. An unknown size runs to the end.
+template <typename Visit>
+void for_each_element(Bytes parent, Visit&& visit) {
+  while (auto header = read_header(parent)) {
+    uint64_t available{ parent.size() - header->length };
+    uint64_t size{ header->unknown_size ? available : header->size };
+    if (size > available) return;
+    if (!visit(header->id, parent.subspan(header->length, size))) return;
+    parent = parent.subspan(header->length + size);
+  }
+}
+
+uint64_t read_uint(Bytes payload) {
+  return payload.size() <= 8 ? read_be(payload.data(), payload.size()) : 0;
+}
+
+struct SegmentLayout {
+  uint64_t data_offset;         // Cue positions are relative to this
+  uint64_t timestamp_scale;     // nanoseconds per tick
+};
+
+// From the start of the file: the EBML header, the Segment header and,
+// when it lies within `head`, the Segment's Info.
+std::optional<SegmentLayout> segment_layout(Bytes head) {
+  auto ebml = read_header(head);
+  if (!ebml || ebml->id != ebml_id || ebml->unknown_size || ebml->size > head.size() - ebml->length) {
+    return std::nullopt;
+  }
+
+  Bytes rest{ head.subspan(ebml->length + ebml->size) };
+  auto segment = read_header(rest);
+  if (!segment || segment->id != segment_id) {
+    return std::nullopt;
+  }
+
+  SegmentLayout layout{ head.size() - rest.size() + segment->length, 1'000'000 };
+
+  // Walk the Segment's children as far as the window goes.
+  for_each_element(rest.subspan(segment->length), [&layout](uint32_t id, Bytes payload) {
+    if (id != info_id) {
+      return true;
+    }
+    for_each_element(payload, [&layout](uint32_t child, Bytes value) {
+      if (child == timestamp_scale_id && read_uint(value) != 0) {
+        layout.timestamp_scale = read_uint(value);
+      }
+      return true;
+    });
+    return false;
+  });
+
+  return layout;
+}
+
+std::vector<Point> matroska_keyframes(Bytes cues, const SegmentLayout& layout) {
+  std::vector<Point> points;
+
+  for_each_element(cues, [&](uint32_t id, Bytes cue_point) {
+    if (id != cue_point_id) {
+      return true;
+    }
+
+    uint64_t time{ 0 };
+    std::optional<uint64_t> position;
+    for_each_element(cue_point, [&](uint32_t child, Bytes value) {
+      if (child == cue_time_id) {
+        time = read_uint(value);
+      } else if (child == cue_track_positions_id && !position) {
+        // Every track listed points at the same cluster; take the first.
+        for_each_element(value, [&position](uint32_t field, Bytes field_value) {
+          if (field == cue_cluster_position_id) {
+            position = read_uint(field_value);
+          }
+          return !position;
+        });
+      }
+      return true;
+    });
+
+    if (position) {
+      points.push_back({ to_ms(time, layout.timestamp_scale, 1'000'000), layout.data_offset + *position });
+    }
+    return true;
+  });
+
+  return points;
+}
+
+} // namespace
+
+SeekIndex SeekIndex::read(const FileHandle& file, const core::MediaInfo& media) {
+  const auto& container{ media.container };
+  if (container.index_size == 0 || container.index_size > max_source_bytes) {
+    return {};
+  }
+
+  std::vector<unsigned char> source(container.index_size);
+  if (!file.read_exact(source.data(), source.size(), container.index_offset)) {
+    LOG_WARN("Failed to read the container index of ", media.file_path);
+    return {};
+  }
+
+  std::vector<Point> points;
+  switch (container.format) {
+    case core::ContainerInfo::Format::mp4:
+      if (auto moov = find_box(Bytes{ source }, fourcc("moov"))) {
+        points = mp4_keyframes(*moov);
+
+        // A fragmented file's moov lists no samples; its fragments do.
+        if (points.empty() && container.fragmented) {
+          uint64_t moov_end{ container.index_offset + container.index_size };
+          auto fragments = mp4_fragments(file, media.file_size, moov_end, *moov);
+          auto index = from_points(std::move(fragments.points));
+          if (!index.empty() && fragments.end.offset > index.offsets_.back()) {
+            index.end_ = fragments.end;
+          }
+          return index;
+        }
+      }
+      break;
+
+    case core::ContainerInfo::Format::matroska: {
+      std::vector<unsigned char> head(std::min<uint64_t>(matroska_head_bytes, media.file_size));
+      if (!file.read_exact(head.data(), head.size(), 0)) {
+        return {};
+      }
+
+      auto layout = segment_layout(head);
+      auto cues = read_header(source);
+      if (layout && cues && cues->id == cues_id && !cues->unknown_size && cues->size <= source.size() - cues->length) {
+        points = matroska_keyframes(Bytes{ source }.subspan(cues->length, cues->size), *layout);
+      }
+      break;
+    }
+
+    case core::ContainerInfo::Format::unknown:
+      break;
+  }
+
+  return from_points(std::move(points));
+}
+
+SeekIndex SeekIndex::from_points(std::vector<Point> points) {
+  auto by_time = [](const Point& a, const Point& b) { return a.time_ms < b.time_ms; };
+  if (!std::is_sorted(points.begin(), points.end(), by_time)) {
+    std::stable_sort(points.begin(), points.end(), by_time);
+  }
+
+  SeekIndex index;
+  index.times_ms_.reserve(points.size());
+  index.offsets_.reserve(points.size());
+  for (const auto& point : points) {
+    index.times_ms_.push_back(point.time_ms);
+    index.offsets_.push_back(point.offset);
+  }
+  return index;
+}
+
+std::optional<SeekIndex::Point> SeekIndex::end() const {
+  if (end_.offset == 0) {
+    return std::nullopt;
+  }
+  return end_;
+}
+
+std::optional<SeekIndex::Point> SeekIndex::find(uint32_t time_ms) const {
+  if (times_ms_.empty()) {
+    return std::nullopt;
+  }
+
+  auto after = std::upper_bound(times_ms_.begin(), times_ms_.end(), time_ms);
+  std::size_t i{ after == times_ms_.begin() ? 0 : static_cast<std::size_t>(after - times_ms_.begin()) - 1 };
+  return Point{ times_ms_[i], offsets_[i] };
+}
+
+std::size_t SeekIndex::bytes() const {
+  return sizeof(SeekIndex)
+    + times_ms_.capacity() * sizeof(uint32_t)
+    + offsets_.capacity() * sizeof(uint64_t);
+}
+
+} // namespace venturi::adapters
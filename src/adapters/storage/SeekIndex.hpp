@@ -0,0 +1,59 @@
+#pragma once
+#include "../../core/entities/MediaInfo.hpp"
+#include "FileHandle.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace venturi::adapters {
+
+// Keyframe times and byte offsets of one title, sorted by time, so a
+// timestamp can be turned into the Range a player should start from.
+//
+// MP4 files are indexed from the video track's sample tables (stts, stss,
+// stsc, stsz, stco/co64), fragmented MP4s from the moof of every fragment
+// that opens on a keyframe, Matroska files from their Cues, whose positions
+// are cluster starts. Edit lists are not applied: times are decode times
+// of the track, which is what players seek by.
+class SeekIndex {
+public:
+  struct Point {
+    uint32_t time_ms;
+    uint64_t offset;
+  };
+
+  // Reads the index the probe located (MP4 moov, Matroska Cues) and
+  // decodes it. An empty index means the file has none we can use, such
+  // as a fragmented MP4 whose moov lists no samples. Blocking.
+  static SeekIndex read(const FileHandle& file, const core::MediaInfo& media);
+
+  // The last keyframe at or before `time_ms`, else the first one.
+  std::optional<Point> find(uint32_t time_ms) const;
+
+  // Keyframes in time order; for a fragmented MP4 each one starts a
+  // fragment, so consecutive points bound self-contained byte ranges.
+  Point at(std::size_t i) const { return { times_ms_[i], offsets_[i] }; }
+
+  // Where the last fragment ends, in time and bytes. Known only for
+  // fragmented MP4s.
+  std::optional<Point> end() const;
+
+  bool empty() const { return times_ms_.empty(); }
+  std::size_t size() const { return times_ms_.size(); }
+  std::size_t bytes() const;
+
+  // Indexes past this size are not read.
+  static constexpr uint64_t max_source_bytes{ 64ull * 1024 * 1024 };
+
+private:
+  // Kept apart so that the search walks four bytes per keyframe.
+  std::vector<uint32_t> times_ms_;
+  std::vector<uint64_t> offsets_;
+  Point end_{ 0, 0 };
+
+  static SeekIndex from_points(std::vector<Point> points);
+};
+
+} // namespace venturi::adapters
@@ -0,0 +1,67 @@
+#include "SeekIndexCache.hpp"
+#include "../../../app/Logger.hpp"
+
+namespace venturi::adapters {
+
+SeekIndexCache::SeekIndexCache(uint64_t budget_bytes)
+  : budget_bytes_(budget_bytes)
+{}
+
+std::shared_ptr<const SeekIndex> SeekIndexCache::find(const core::MediaInfo& media) {
+  std::lock_guard lock(mutex_);
+
+  auto it = entries_.find(media.id);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+
+  if (it->second.modified_at != media.modified_at || it->second.file_size != media.file_size) {
+    this->erase(it);
+    return nullptr;
+  }
+
+  lru_.splice(lru_.begin(), lru_, it->second.position);
+  return it->second.index;
+}
+
+std::shared_ptr<const SeekIndex> SeekIndexCache::load(const core::MediaInfo& media) {
+  std::error_code ec;
+  FileHandle file{ FileHandle::open_read(media.file_path, ec) };
+  if (ec) {
+    return nullptr;
+  }
+
+  auto start{ std::chrono::steady_clock::now() };
+  auto index = std::make_shared<const SeekIndex>(SeekIndex::read(file, media));
+  auto elapsed{ std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start) };
+  LOG_DEBUG("Seek index of ", media.file_path, ": ", index->size(), " keyframes in ", elapsed.count(), " ms");
+
+  if (this->enabled() && index->bytes() <= budget_bytes_) {
+    this->insert(media, index);
+  }
+  return index;
+}
+
+void SeekIndexCache::insert(const core::MediaInfo& media, std::shared_ptr<const SeekIndex> index) {
+  std::lock_guard lock(mutex_);
+
+  if (auto it = entries_.find(media.id); it != entries_.end()) {
+    this->erase(it);
+  }
+
+  used_bytes_ += index->bytes();
+  lru_.push_front(media.id);
+  entries_.emplace(media.id, Slot{ std::move(index), media.modified_at, media.file_size, lru_.begin() });
+
+  while (used_bytes_ > budget_bytes_ && !lru_.empty()) {
+    this->erase(entries_.find(lru_.back()));
+  }
+}
+
+void SeekIndexCache::erase(std::unordered_map<core::MediaId, Slot>::iterator it) {
+  used_bytes_ -= it->second.index->bytes();
+  lru_.erase(it->second.position);
+  entries_.erase(it);
+}
+
+} // namespace venturi::adapters
@@ -0,0 +1,55 @@
+#pragma once
+#include "../../core/entities/MediaInfo.hpp"
+#include "SeekIndex.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace venturi::adapters {
+
+// Size-bounded cache of decoded seek indexes, keyed by MediaInfo::id.
+//
+// An index is built the first time a title is seeked and dropped LRU-first
+// once the budget is exceeded, or as soon as the file's modified_at or
+// size changes. Files without a usable index are cached too, as empty
+// indexes, so they are not re-read on every seek.
+class SeekIndexCache {
+public:
+  explicit SeekIndexCache(uint64_t budget_bytes);
+
+  // Returns the index for `media`, or nullptr if absent or stale.
+  std::shared_ptr<const SeekIndex> find(const core::MediaInfo& media);
+
+  // Reads and decodes the index of `media`, then inserts it. Blocking;
+  // run it off the I/O threads. Returns nullptr if the file cannot be
+  // opened.
+  std::shared_ptr<const SeekIndex> load(const core::MediaInfo& media);
+
+  bool enabled() const { return budget_bytes_ > 0; }
+
+private:
+  using LruList = std::list<core::MediaId>;
+
+  struct Slot {
+    std::shared_ptr<const SeekIndex> index;
+    std::chrono::system_clock::time_point modified_at;
+    uint64_t file_size;
+    LruList::iterator position;
+  };
+
+  void insert(const core::MediaInfo& media, std::shared_ptr<const SeekIndex> index);
+  void erase(std::unordered_map<core::MediaId, Slot>::iterator it);
+
+  const uint64_t budget_bytes_;
+
+  std::mutex mutex_;
+  LruList lru_;   // most recently used at the front
+  std::unordered_map<core::MediaId, Slot> entries_;
+  uint64_t used_bytes_{ 0 };
+};
+
+} // namespace venturi::adapters
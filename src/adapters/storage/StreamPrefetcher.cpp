@@ -0,0 +1,154 @@
+#include "StreamPrefetcher.hpp"
+#include "MediaReader.hpp"
+
+#include <boost/asio/post.hpp>
+#include <fcntl.h>
+#include <algorithm>
+
+namespace venturi::adapters {
+
+namespace {
+
+// Consumption that must be seen contiguously before we trust it is playback.
+constexpr uint64_t min_sequential_run{ 1024 * 1024 };
+
+// Distance from the playhead a new request may start and still count as
+// the same run (players overlap or leave small gaps between ranges).
+constexpr uint64_t seek_tolerance{ 2 * 1024 * 1024 };
+
+// Rate samples closer together than this are too noisy to use.
+constexpr auto min_rate_interval{ std::chrono::milliseconds(250) };
+
+// Hints smaller than this are not worth a trip to the disk pool.
+constexpr uint64_t min_hint_bytes{ 512 * 1024 };
+
+} // namespace
+
+StreamPrefetcher::StreamPrefetcher(
+  MediaReader&            reader,
+  const Config&           config,
+  const core::MediaInfo&  media,
+  uint64_t                file_size
+)
+  : reader_(reader)
+  , config_(config)
+  , media_id_(media.id)
+  , path_(media.file_path)
+  , file_size_(file_size)
+{
+  // A second descriptor of an already-open file: only the dentry lookup.
+  std::error_code ec;
+  file_ = std::make_shared<FileHandle>(FileHandle::open_read(path_, ec));
+}
+
+void StreamPrefetcher::on_request(uint64_t offset) {
+  const uint64_t distance{ offset > playhead_ ? offset - playhead_ : playhead_ - offset };
+
+  if (distance > seek_tolerance || offset < run_start_) {
+    // Seek: whatever was read ahead is no longer ahead of anyone.
+    run_start_ = offset;
+    prefetched_until_ = offset;
+    dropped_until_ = std::min(dropped_until_, offset);
+    rate_time_ = {};
+  }
+
+  playhead_ = offset;
+}
+
+void StreamPrefetcher::on_progress(uint64_t offset) {
+  if (offset <= playhead_) {
+    return;
+  }
+
+  this->update_rate(offset, Clock::now());
+  playhead_ = offset;
+
+  if (playhead_ - run_start_ >= min_sequential_run) {
+    this->schedule();
+  }
+}
+
+void StreamPrefetcher::update_rate(uint64_t offset, Clock::time_point now) {
+  if (rate_time_ == Clock::time_point{}) {
+    rate_time_ = now;
+    rate_offset_ = offset;
+    return;
+  }
+
+  const auto elapsed{ now - rate_time_ };
+  if (elapsed < min_rate_interval) {
+    return;
+  }
+
+  const double seconds{ std::chrono::duration<double>(elapsed).count() };
+  const double sample{ static_cast<double>(offset - rate_offset_) / seconds };
+
+  // EWMA so a burst (initial buffer fill) does not dominate the estimate.
+  bytes_per_second_ = bytes_per_second_ == 0.0
+    ? sample
+    : 0.8 * bytes_per_second_ + 0.2 * sample;
+
+  rate_time_ = now;
+  rate_offset_ = offset;
+}
+
+uint64_t StreamPrefetcher::window_bytes() const {
+  const double wanted{ bytes_per_second_ * config_.readahead_seconds };
+  return std::clamp<uint64_t>(
+    static_cast<uint64_t>(wanted),
+    config_.readahead_min_bytes,
+    config_.readahead_max_bytes
+  );
+}
+
+void StreamPrefetcher::schedule() {
+  const uint64_t window{ this->window_bytes() };
+  const uint64_t target{ std::min(file_size_, playhead_ + window) };
+
+  uint64_t ahead_from{ std::max(prefetched_until_, playhead_) };
+  uint64_t ahead_length{ 0 };
+
+  // Top up once half the window has been consumed, not on every progress tick.
+  if (target > ahead_from && target - ahead_from >= std::max(window / 2, min_hint_bytes)) {
+    ahead_length = target - ahead_from;
+    prefetched_until_ = target;
+  }
+
+  uint64_t behind_from{ dropped_until_ };
+  uint64_t behind_length{ 0 };
+
+  if (config_.drop_behind_bytes > 0 && playhead_ > config_.drop_behind_bytes) {
+    const uint64_t drop_until{ playhead_ - config_.drop_behind_bytes };
+
+    // Another session may still need those pages.
+    if (drop_until > behind_from + min_hint_bytes && reader_.active_streams(media_id_) <= 1) {
+      behind_length = drop_until - behind_from;
+      dropped_until_ = drop_until;
+    }
+  }
+
+  if ((ahead_length == 0 && behind_length == 0) || !file_->is_open()) {
+    return;
+  }
+
+  // readahead(2) blocks until the I/O is queued, so keep it off this thread.
+  asio::post(reader_.disk_pool(), [
+    file = file_, ahead_from, ahead_length, behind_from, behind_length
+  ] {
+    if (ahead_length > 0) {
+#if defined(__linux__)
+      ::readahead(file->native_handle(), static_cast<off64_t>(ahead_from), ahead_length);
+#else
+      ::posix_fadvise(file->native_handle(), static_cast<off_t>(ahead_from),
+                      static_cast<off_t>(ahead_length), POSIX_FADV_WILLNEED);
+#endif
+    }
+
+    if (behind_length > 0) {
+      ::posix_fadvise(file->native_handle(), static_cast<off_t>(behind_from),
+                      static_cast<off_t>(behind_length), POSIX_FADV_DONTNEED);
+    }
+  });
+}
+
+} // namespace venturi::adapters
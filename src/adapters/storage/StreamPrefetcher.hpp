@@ -0,0 +1,70 @@
+#pragma once
+#include "../../core/entities/MediaInfo.hpp"
+#include "../../../app/Config.hpp"
+#include "FileHandle.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace venturi::adapters {
+
+class MediaReader;
+
+// Readahead for one session streaming one title.
+//
+// Watches where the client is reading across successive Range requests and
+// within a long response. Once consumption is sequential it keeps the page
+// cache filled `readahead_seconds` of observed bitrate ahead of the playhead
+// with readahead(2), and, while nobody else streams the title, drops pages
+// far behind it with POSIX_FADV_DONTNEED. A seek resets the run.
+//
+// Not thread-safe; drive it from the owning session's executor. The hints
+// themselves are issued on the MediaReader's disk pool.
+class StreamPrefetcher {
+public:
+  StreamPrefetcher(
+    MediaReader&            reader,
+    const Config&           config,
+    const core::MediaInfo&  media,
+    uint64_t                file_size
+  );
+
+  core::MediaId media_id() const { return media_id_; }
+
+  // A new request starting at `offset` arrived on the session.
+  void on_request(uint64_t offset);
+
+  // The response has delivered the file up to `offset`.
+  void on_progress(uint64_t offset);
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  void update_rate(uint64_t offset, Clock::time_point now);
+  void schedule();
+
+  uint64_t window_bytes() const;
+
+  MediaReader& reader_;
+  const Config& config_;
+  core::MediaId media_id_;
+  std::string path_;
+  uint64_t file_size_;
+
+  // Shared with hints still queued on the disk pool.
+  std::shared_ptr<const FileHandle> file_;
+
+  uint64_t playhead_{ 0 };
+  uint64_t run_start_{ 0 };
+  uint64_t prefetched_until_{ 0 };
+  uint64_t dropped_until_{ 0 };
+
+  Clock::time_point rate_time_{};
+  uint64_t rate_offset_{ 0 };
+  double bytes_per_second_{ 0.0 };
+};
+
+} // namespace venturi::adapters
@@ -0,0 +1,54 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace venturi::core {
+
+// What probing a file's container found. Trivially copyable, so it is
+// stored inline in catalog entries and in the catalog index as is. A
+// default value (format unknown) means not probed, or not understood.
+struct ContainerInfo {
+  enum class Format : uint8_t { unknown, mp4, matroska };
+
+  struct Track {
+    enum class Kind : uint8_t { other, video, audio, subtitle };
+
+    Kind kind = Kind::other;
+
+    // MP4 sample entry type ("avc1", "mp4a") or Matroska CodecID
+    // ("V_VP9", "A_OPUS"), truncated to fit, NUL-padded.
+    std::array<char, 15> codec{};
+
+    std::string_view codec_name() const {
+      std::string_view name{ codec.data(), codec.size() };
+      return name.substr(0, name.find('\0'));
+    }
+
+    bool operator==(const Track&) const = default;
+  };
+
+  static constexpr std::size_t max_tracks = 4;
+
+  Format format = Format::unknown;
+  bool faststart = false;     // the index precedes the media data
+  bool fragmented = false;    // MP4 made of movie fragments (moof)
+  uint8_t track_count = 0;
+  uint32_t duration_ms = 0;
+  uint64_t bitrate = 0;       // bits per second, whole file over duration
+
+  // The index (MP4 moov box, Matroska Cues element) and where media data
+  // starts (first mdat or moof, first Cluster); zero when not found.
+  uint64_t index_offset = 0;
+  uint64_t index_size = 0;
+  uint64_t media_offset = 0;
+
+  std::array<Track, max_tracks> tracks{};
+
+  bool probed() const { return format != Format::unknown; }
+
+  bool operator==(const ContainerInfo&) const = default;
+};
+
+} // namespace venturi::core
@@ -0,0 +1,139 @@
+#include "MediaId.hpp"
+
+namespace venturi::core {
+
+namespace {
+
+constexpr uint64_t prime1{ 0x9E3779B185EBCA87ULL };
+constexpr uint64_t prime2{ 0xC2B2AE3D27D4EB4FULL };
+constexpr uint64_t prime3{ 0x165667B19E3779F9ULL };
+constexpr uint64_t prime4{ 0x85EBCA77C2B2AE63ULL };
+constexpr uint64_t prime5{ 0x27D4EB2F165667C5ULL };
+
+constexpr uint64_t rotl(uint64_t value, int bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+// Little-endian whatever the host; compilers turn these into plain loads.
+uint64_t read64(const unsigned char* p) {
+  uint64_t value{ 0 };
+  for (int i{ 7 }; i >= 0; --i) {
+    value = (value << 8) | p[i];
+  }
+  return value;
+}
+
+uint32_t read32(const unsigned char* p) {
+  return static_cast<uint32_t>(p[0])
+    | static_cast<uint32_t>(p[1]) << 8
+    | static_cast<uint32_t>(p[2]) << 16
+    | static_cast<uint32_t>(p[3]) << 24;
+}
+
+uint64_t round(uint64_t acc, uint64_t input) {
+  acc += input * prime2;
+  acc = rotl(acc, 31);
+  return acc * prime1;
+}
+
+uint64_t merge_round(uint64_t acc, uint64_t value) {
+  acc ^= round(0, value);
+  return acc * prime1 + prime4;
+}
+
+constexpr char hex_digits[]{ "0123456789abcdef" };
+
+int hex_value(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+} // namespace
+
+uint64_t xxh64(const void* data, std::size_t size, uint64_t seed) {
+  const auto* p = static_cast<const unsigned char*>(data);
+  const auto* end = p + size;
+  uint64_t hash;
+
+  if (size >= 32) {
+    uint64_t v1{ seed + prime1 + prime2 };
+    uint64_t v2{ seed + prime2 };
+    uint64_t v3{ seed };
+    uint64_t v4{ seed - prime1 };
+
+    for (; p + 32 <= end; p += 32) {
+      v1 = round(v1, read64(p));
+      v2 = round(v2, read64(p + 8));
+      v3 = round(v3, read64(p + 16));
+      v4 = round(v4, read64(p + 24));
+    }
+
+    hash = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+    hash = merge_round(hash, v1);
+    hash = merge_round(hash, v2);
+    hash = merge_round(hash, v3);
+    hash = merge_round(hash, v4);
+  } else {
+    hash = seed + prime5;
+  }
+
+  hash += size;
+
+  for (; p + 8 <= end; p += 8) {
+    hash ^= round(0, read64(p));
+    hash = rotl(hash, 27) * prime1 + prime4;
+  }
+  if (p + 4 <= end) {
+    hash ^= static_cast<uint64_t>(read32(p)) * prime1;
+    hash = rotl(hash, 23) * prime2 + prime3;
+    p += 4;
+  }
+  for (; p < end; ++p) {
+    hash ^= *p * prime5;
+    hash = rotl(hash, 11) * prime1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= prime2;
+  hash ^= hash >> 29;
+  hash *= prime3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+MediaId MediaId::from_relative_path(std::string_view relative_path) {
+  return MediaId{ xxh64(relative_path.data(), relative_path.size()) };
+}
+
+std::optional<MediaId> MediaId::parse(std::string_view hex) {
+  if (hex.size() != 16) {
+    return std::nullopt;
+  }
+
+  uint64_t value{ 0 };
+  for (char c : hex) {
+    int digit = hex_value(c);
+    if (digit < 0) {
+      return std::nullopt;
+    }
+    value = (value << 4) | static_cast<uint64_t>(digit);
+  }
+  return MediaId{ value };
+}
+
+std::array<char, 16> MediaId::hex() const {
+  std::array<char, 16> out;
+  for (int i{ 15 }; i >= 0; --i) {
+    out[i] = hex_digits[(value >> ((15 - i) * 4)) & 0xf];
+  }
+  return out;
+}
+
+std::string MediaId::to_string() const {
+  auto digits = this->hex();
+  return { digits.begin(), digits.end() };
+}
+
+} // namespace venturi::core
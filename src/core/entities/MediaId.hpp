@@ -0,0 +1,46 @@
+#pragma once
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace venturi::core {
+
+// Names a title for as long as its file keeps its place below the media
+// root: the XXH64 of the root-relative path. That is stable across
+// restarts, rebuilds and standard libraries, so clients may bookmark it.
+//
+// Inside the server an id is a plain 64-bit value, compared and hashed as
+// an integer; the 16-digit hex form exists only at the HTTP edge.
+struct MediaId {
+  uint64_t value = 0;
+
+  static MediaId from_relative_path(std::string_view relative_path);
+
+  // Exactly 16 hex digits in either case; nullopt for anything else.
+  static std::optional<MediaId> parse(std::string_view hex);
+
+  // 16 lowercase hex digits.
+  std::array<char, 16> hex() const;
+  std::string to_string() const;
+
+  auto operator<=>(const MediaId&) const = default;
+};
+
+// XXH64 of `size` bytes, as specified by the xxHash project; the result
+// does not depend on the platform's byte order.
+uint64_t xxh64(const void* data, std::size_t size, uint64_t seed = 0);
+
+} // namespace venturi::core
+
+// The value is already a well-mixed hash.
+template <>
+struct std::hash<venturi::core::MediaId> {
+  std::size_t operator()(venturi::core::MediaId id) const noexcept {
+    return static_cast<std::size_t>(id.value);
+  }
+};
@@ -0,0 +1,60 @@
+#include "MediaInfo.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cinttypes>
+#include <cstdio>
+
+namespace venturi::core {
+
+namespace {
+
+constexpr std::string_view mime_names[]{
+  "video/mp4",
+  "video/webm",
+  "video/x-matroska",
+  "video/x-msvideo",
+};
+
+bool iequals(std::string_view a, std::string_view b) {
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+    [](char x, char y) { return std::tolower(static_cast<unsigned char>(x)) == y; });
+}
+
+} // namespace
+
+std::string_view to_string(MimeType type) {
+  return mime_names[static_cast<std::size_t>(type)];
+}
+
+MimeType mime_type_for_extension(std::string_view extension) {
+  if (iequals(extension, ".webm")) return MimeType::webm;
+  if (iequals(extension, ".mkv")) return MimeType::matroska;
+  if (iequals(extension, ".avi")) return MimeType::msvideo;
+  return MimeType::mp4;
+}
+
+std::optional<MimeType> parse_mime_type(std::string_view mime) {
+  for (std::size_t i{ 0 }; i < std::size(mime_names); ++i) {
+    if (mime == mime_names[i]) {
+      return static_cast<MimeType>(i);
+    }
+  }
+  return std::nullopt;
+}
+
+ETag MediaInfo::etag() const {
+  ETag tag;
+  if (inode == 0) {
+    return tag;
+  }
+
+  int length = std::snprintf(tag.text.data(), tag.text.size(), "\"%" PRIx64 "-%" PRIx64 "-%" PRIx64 "\"",
+    inode, file_size,
+    static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      modified_at.time_since_epoch()).count()));
+  tag.length = static_cast<uint8_t>(length);
+  return tag;
+}
+
+} // namespace venturi::core
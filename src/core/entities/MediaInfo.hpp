@@ -1,22 +1,65 @@
 #pragma once
+#include "ContainerInfo.hpp"
+#include "MediaId.hpp"
 #include <string>
+#include <array>
 #include <cstdint>
 #include <chrono>
 #include <filesystem>
+#include <memory>
+#include <optional>
+#include <string_view>
 
 namespace venturi::core {
 
+// Every container the server catalogues maps to one of these, so entries
+// store a byte instead of a string.
+enum class MimeType : uint8_t { mp4, webm, matroska, msvideo };
+
+std::string_view to_string(MimeType type);
+
+// By file extension (".mkv", any case); unknown extensions are served as mp4.
+MimeType mime_type_for_extension(std::string_view extension);
+
+std::optional<MimeType> parse_mime_type(std::string_view mime);
+
+// A strong validator held inline, quoted and ready for the ETag header.
+struct ETag {
+  std::array<char, 56> text{};
+  uint8_t length = 0;
+
+  bool empty() const { return length == 0; }
+  std::string_view view() const { return { text.data(), length }; }
+};
+
 struct MediaInfo {
-  std::string id;
-  std::filesystem::path file_path;
-  std::filesystem::path optimized_path;
-  
-  std::string mime_type = "video/mp4";
+  MediaId id;
+  MimeType mime_type = MimeType::mp4;
+
+  // Absolute, as plain text: a std::filesystem::path would also carry a
+  // parsed list of its components, several times the size of the text.
+  // The catalog orders entries by these strings.
+  std::string file_path;
+  std::string optimized_path;
   
   std::chrono::system_clock::time_point created_at;
   std::chrono::system_clock::time_point modified_at;
+
+  // Captured at scan time; empty for entries that were never stat'ed.
+  uint64_t inode = 0;
+  uint64_t file_size = 0;
+
+  // Probed at scan time; unknown for unreadable or foreign containers.
+  ContainerInfo container;
+
+  // Derived from inode, size and modified_at.
+  ETag etag() const;
 };
 
+// A catalog entry as handed out by repositories: shared and immutable, so
+// it is cheap to pass around and stays valid while the catalog changes.
+using MediaHandle = std::shared_ptr<const MediaInfo>;
+
 struct ByteRange {
   uint64_t start = 0;
   uint64_t end = 0;
@@ -31,4 +74,19 @@ struct ByteRange {
   }
 };
 
+// Fixed-capacity list of byte ranges, so parsing a header never allocates.
+struct ByteRangeSet {
+  static constexpr std::size_t capacity = 64;
+
+  std::array<ByteRange, capacity> ranges{};
+  std::size_t count = 0;
+
+  bool empty() const { return count == 0; }
+  std::size_t size() const { return count; }
+
+  const ByteRange& front() const { return ranges[0]; }
+  const ByteRange* begin() const { return ranges.data(); }
+  const ByteRange* end() const { return ranges.data() + count; }
+};
+
 } // namespace venturi::core
\ No newline at end of file
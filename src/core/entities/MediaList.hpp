@@ -0,0 +1,57 @@
+#pragma once
+#include "MediaInfo.hpp"
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <span>
+
+namespace venturi::core {
+
+// A read-only run of catalog entries, handed out instead of copies. It
+// keeps the catalog version it was taken from alive, so the entries stay
+// valid for as long as the list does, whatever happens to the catalog.
+class MediaList {
+public:
+  class iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = MediaInfo;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const MediaInfo*;
+    using reference = const MediaInfo&;
+
+    iterator() = default;
+    explicit iterator(const MediaHandle* position) : position_(position) {}
+
+    reference operator*() const { return **position_; }
+    pointer operator->() const { return position_->get(); }
+    iterator& operator++() { ++position_; return *this; }
+    iterator operator++(int) { auto copy{ *this }; ++position_; return copy; }
+    bool operator==(const iterator&) const = default;
+
+  private:
+    const MediaHandle* position_{ nullptr };
+  };
+
+  MediaList() = default;
+  MediaList(std::shared_ptr<const void> owner, std::span<const MediaHandle> entries)
+    : owner_(std::move(owner)), entries_(entries) {}
+
+  iterator begin() const { return iterator{ entries_.data() }; }
+  iterator end() const { return iterator{ entries_.data() + entries_.size() }; }
+
+  std::size_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+
+  const MediaInfo& operator[](std::size_t i) const { return *entries_[i]; }
+  const MediaInfo& back() const { return *entries_.back(); }
+
+  // For callers that keep individual entries beyond the list's lifetime.
+  std::span<const MediaHandle> handles() const { return entries_; }
+
+private:
+  std::shared_ptr<const void> owner_;
+  std::span<const MediaHandle> entries_;
+};
+
+} // namespace venturi::core
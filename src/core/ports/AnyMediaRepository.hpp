@@ -0,0 +1,93 @@
+#pragma once
+#include "MediaRepository.hpp"
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace venturi::core {
+
+// Type-erased MediaRepository: holds any repository behind one virtual
+// call per operation. For tests and tools that want to swap stores at run
+// time; the server binds MediaService to its repository directly.
+// Copies share the repository.
+class AnyMediaRepository {
+public:
+  template <MediaRepository Repo>
+    requires (!std::same_as<std::remove_cv_t<Repo>, AnyMediaRepository>)
+  explicit AnyMediaRepository(std::shared_ptr<Repo> repository)
+    : repository_(std::make_shared<Model<Repo>>(std::move(repository)))
+  {}
+
+  MediaHandle find_by_id(MediaId id) const { return repository_->find_by_id(id); }
+  MediaList list_all() const { return repository_->list_all(); }
+
+  MediaList list_page(const std::filesystem::path& after, std::size_t limit) const {
+    return repository_->list_page(after, limit);
+  }
+
+  std::size_t scan_directory(const std::filesystem::path& path, const ScanHooks& hooks) {
+    return repository_->scan_directory(path, hooks);
+  }
+
+  void save(const MediaInfo& info) { repository_->save(info); }
+  bool remove(MediaId id) { return repository_->remove(id); }
+  bool exists(MediaId id) const { return repository_->exists(id); }
+
+  uint64_t get_file_size(const std::filesystem::path& file_path) const {
+    return repository_->get_file_size(file_path);
+  }
+
+  uint64_t generation() const { return repository_->generation(); }
+
+private:
+  class Interface {
+  public:
+    virtual ~Interface() = default;
+
+    virtual MediaHandle find_by_id(MediaId id) const = 0;
+    virtual MediaList list_all() const = 0;
+    virtual MediaList list_page(const std::filesystem::path& after, std::size_t limit) const = 0;
+    virtual std::size_t scan_directory(const std::filesystem::path& path, const ScanHooks& hooks) = 0;
+    virtual void save(const MediaInfo& info) = 0;
+    virtual bool remove(MediaId id) = 0;
+    virtual bool exists(MediaId id) const = 0;
+    virtual uint64_t get_file_size(const std::filesystem::path& file_path) const = 0;
+    virtual uint64_t generation() const = 0;
+  };
+
+  template <typename Repo>
+  class Model final : public Interface {
+  public:
+    explicit Model(std::shared_ptr<Repo> repository) : repository_(std::move(repository)) {}
+
+    MediaHandle find_by_id(MediaId id) const override { return repository_->find_by_id(id); }
+    MediaList list_all() const override { return repository_->list_all(); }
+
+    MediaList list_page(const std::filesystem::path& after, std::size_t limit) const override {
+      return repository_->list_page(after, limit);
+    }
+
+    std::size_t scan_directory(const std::filesystem::path& path, const ScanHooks& hooks) override {
+      return repository_->scan_directory(path, hooks);
+    }
+
+    void save(const MediaInfo& info) override { repository_->save(info); }
+    bool remove(MediaId id) override { return repository_->remove(id); }
+    bool exists(MediaId id) const override { return repository_->exists(id); }
+
+    uint64_t get_file_size(const std::filesystem::path& file_path) const override {
+      return repository_->get_file_size(file_path);
+    }
+
+    uint64_t generation() const override { return repository_->generation(); }
+
+  private:
+    std::shared_ptr<Repo> repository_;
+  };
+
+  std::shared_ptr<Interface> repository_;
+};
+
+static_assert(MediaRepository<AnyMediaRepository>);
+
+} // namespace venturi::core
@@ -0,0 +1,23 @@
+#pragma once
+#include <concepts>
+#include <cstdint>
+#include <string>
+
+namespace venturi::core {
+
+// A server the application can start and stop. Held by its concrete type;
+// the concept only pins down the shape.
+template <typename Server>
+concept HttpServer = requires(
+  Server&             server,
+  const Server&       const_server,
+  const std::string&  host,
+  uint16_t            port,
+  uint32_t            thread_count
+) {
+  server.start(host, port, thread_count);
+  server.stop();
+  { const_server.is_running() } -> std::same_as<bool>;
+};
+
+} // namespace venturi::core
@@ -0,0 +1,55 @@
+#pragma once
+#include "../entities/MediaInfo.hpp"
+#include "../entities/MediaList.hpp"
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <stop_token>
+
+namespace venturi::core {
+
+// Hooks into a running scan; every member is optional. A stop request ends
+// the walk early, keeping whatever was found so far. Scans may walk several
+// directories at once, so the callbacks must be safe to call concurrently.
+struct ScanHooks {
+  std::function<void(const MediaInfo&)> on_found;
+  std::function<void(const std::filesystem::path&)> on_directory;
+  std::stop_token stop_token;
+};
+
+// What MediaService needs from a catalog store. Services are instantiated
+// against the concrete repository, so these calls bind statically and can
+// inline; AnyMediaRepository erases the type where that is not wanted.
+//
+//   find_by_id      the entry with an id, or null
+//   list_all        every entry, in path order
+//   list_page       up to `limit` entries whose path sorts strictly after
+//                   `after`, in list_all() order; an empty `after` starts
+//                   from the beginning
+//   generation      changes whenever the catalog does (save, remove or
+//                   scan), so derived data such as a serialized listing
+//                   can be cached per generation
+template <typename Repo>
+concept MediaRepository = requires(
+  Repo&                         repository,
+  const Repo&                   const_repository,
+  MediaId                       id,
+  const MediaInfo&              info,
+  const std::filesystem::path&  path,
+  std::size_t                   limit,
+  const ScanHooks&              hooks
+) {
+  { const_repository.find_by_id(id) } -> std::same_as<MediaHandle>;
+  { const_repository.list_all() } -> std::same_as<MediaList>;
+  { const_repository.list_page(path, limit) } -> std::same_as<MediaList>;
+  { repository.scan_directory(path, hooks) } -> std::same_as<std::size_t>;
+  repository.save(info);
+  { repository.remove(id) } -> std::same_as<bool>;
+  { const_repository.exists(id) } -> std::same_as<bool>;
+  { const_repository.get_file_size(path) } -> std::same_as<uint64_t>;
+  { const_repository.generation() } -> std::same_as<uint64_t>;
+};
+
+} // namespace venturi::core
@@ -0,0 +1,268 @@
+#include "JobManager.hpp"
+#include "../../../app/Logger.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <random>
+
+namespace venturi::core {
+
+std::string_view to_string(JobState state) {
+  switch (state) {
+    case JobState::queued:    return "queued";
+    case JobState::running:   return "running";
+    case JobState::completed: return "completed";
+    case JobState::cancelled: return "cancelled";
+    case JobState::failed:    return "failed";
+  }
+  return "unknown";
+}
+
+Job::Job(std::string id, std::string kind, std::string key)
+  : id_(std::move(id))
+  , kind_(std::move(kind))
+  , key_(std::move(key))
+{}
+
+bool Job::finished() const {
+  auto state{ this->state() };
+  return state != JobState::queued && state != JobState::running;
+}
+
+std::chrono::milliseconds Job::elapsed() const {
+  std::lock_guard lock(mutex_);
+  if (started_at_ == Clock::time_point{}) {
+    return {};
+  }
+
+  auto end{ finished_at_ == Clock::time_point{} ? Clock::now() : finished_at_ };
+  return std::chrono::duration_cast<std::chrono::milliseconds>(end - started_at_);
+}
+
+double Job::files_per_second() const {
+  auto elapsed{ this->elapsed() };
+  if (elapsed.count() <= 0) {
+    return 0.0;
+  }
+  return static_cast<double>(this->files()) * 1000.0 / static_cast<double>(elapsed.count());
+}
+
+std::string Job::error() const {
+  std::lock_guard lock(mutex_);
+  return error_;
+}
+
+void Job::mark_running() {
+  std::lock_guard lock(mutex_);
+  started_at_ = Clock::now();
+  state_.store(JobState::running, std::memory_order_release);
+}
+
+void Job::mark_finished(JobState state, std::string error) {
+  std::lock_guard lock(mutex_);
+  finished_at_ = Clock::now();
+  if (started_at_ == Clock::time_point{}) {
+    started_at_ = finished_at_;
+  }
+  error_ = std::move(error);
+  state_.store(state, std::memory_order_release);
+}
+
+JobManager::JobManager(Options options)
+  : options_(std::move(options))
+  , id_state_(std::random_device{}())
+{
+  const std::size_t worker_count{ std::max<std::size_t>(options_.worker_count, 1) };
+  const std::size_t dedicated{ options_.dedicated_kinds.size() };
+  queues_.resize(1 + dedicated);
+  workers_.reserve(worker_count + dedicated);
+
+  for (std::size_t i{ 0 }; i < worker_count + dedicated; ++i) {
+    const std::size_t lane{ i < worker_count ? 0 : i - worker_count + 1 };
+    workers_.emplace_back([this, lane](std::stop_token stop) {
+      this->run_worker(stop, lane);
+    });
+  }
+}
+
+JobManager::~JobManager() {
+  {
+    std::lock_guard lock(mutex_);
+    for (auto& [id, job] : jobs_) {
+      job->stop_.request_stop();
+    }
+  }
+
+  // jthread requests its own stop and joins.
+  workers_.clear();
+}
+
+std::shared_ptr<Job> JobManager::submit(
+  std::string   kind,
+  std::string   key,
+  Work          work,
+  bool          join_running
+) {
+  std::lock_guard lock(mutex_);
+
+  for (const auto& [id, job] : jobs_) {
+    const bool pending{ join_running ? !job->finished() : job->state() == JobState::queued };
+    if (job->key() == key && pending && !job->stop_.stop_requested()) {
+      LOG_DEBUG("Job ", id, " already covers ", key);
+      return job;
+    }
+  }
+
+  auto job{ std::make_shared<Job>(this->next_id(), std::move(kind), std::move(key)) };
+  jobs_.emplace(job->id(), job);
+  queues_[this->lane_of(job->kind())].push_back({ job, std::move(work) });
+  // Workers of every lane share the condition variable.
+  wake_.notify_all();
+
+  LOG_INFO("Queued ", job->kind(), " job ", job->id());
+  return job;
+}
+
+std::shared_ptr<Job> JobManager::find(const std::string& id) const {
+  std::lock_guard lock(mutex_);
+  auto it{ jobs_.find(id) };
+  return it == jobs_.end() ? nullptr : it->second;
+}
+
+std::vector<std::shared_ptr<Job>> JobManager::list() const {
+  std::lock_guard lock(mutex_);
+
+  std::vector<std::shared_ptr<Job>> result;
+  result.reserve(jobs_.size());
+
+  for (const auto& queue : queues_) {
+    for (const auto& pending : queue) {
+      result.push_back(pending.job);
+    }
+  }
+  for (const auto& [id, job] : jobs_) {
+    if (job->state() == JobState::running) {
+      result.push_back(job);
+    }
+  }
+  for (auto it{ finished_.rbegin() }; it != finished_.rend(); ++it) {
+    if (auto found{ jobs_.find(*it) }; found != jobs_.end()) {
+      result.push_back(found->second);
+    }
+  }
+
+  return result;
+}
+
+bool JobManager::cancel(const std::string& id) {
+  std::lock_guard lock(mutex_);
+
+  auto it{ jobs_.find(id) };
+  if (it == jobs_.end()) {
+    return false;
+  }
+
+  auto job{ it->second };
+  job->stop_.request_stop();
+
+  auto& queue{ queues_[this->lane_of(job->kind())] };
+  auto pending{ std::find_if(queue.begin(), queue.end(), [&](const Pending& p) {
+    return p.job == job;
+  }) };
+  if (pending != queue.end()) {
+    queue.erase(pending);
+    job->mark_finished(JobState::cancelled);
+    this->retire(job);
+  }
+
+  LOG_INFO("Cancel requested for job ", id);
+  return true;
+}
+
+std::size_t JobManager::lane_of(std::string_view kind) const {
+  const auto& kinds{ options_.dedicated_kinds };
+  auto it{ std::find(kinds.begin(), kinds.end(), kind) };
+  return it == kinds.end() ? 0 : static_cast<std::size_t>(it - kinds.begin()) + 1;
+}
+
+void JobManager::wait_idle(std::string_view kind, std::stop_token stop) {
+  std::unique_lock lock(mutex_);
+  wake_.wait(lock, stop, [&] {
+    return std::none_of(jobs_.begin(), jobs_.end(), [&](const auto& entry) {
+      return entry.second->kind() == kind && !entry.second->finished();
+    });
+  });
+}
+
+void JobManager::run_worker(std::stop_token stop, std::size_t lane) {
+  if (options_.on_worker_start) {
+    options_.on_worker_start();
+  }
+
+  auto& queue{ queues_[lane] };
+  while (true) {
+    Pending pending;
+    {
+      std::unique_lock lock(mutex_);
+      if (!wake_.wait(lock, stop, [&queue] { return !queue.empty(); }) || stop.stop_requested()) {
+        return;
+      }
+
+      pending = std::move(queue.front());
+      queue.pop_front();
+      pending.job->mark_running();
+    }
+
+    auto& job{ *pending.job };
+    LOG_INFO("Running ", job.kind(), " job ", job.id());
+
+    JobState outcome{ JobState::completed };
+    std::string error;
+    try {
+      pending.work(job);
+      if (job.stop_token().stop_requested()) {
+        outcome = JobState::cancelled;
+      }
+    } catch (const std::exception& e) {
+      outcome = JobState::failed;
+      error = e.what();
+    } catch (...) {
+      outcome = JobState::failed;
+      error = "unknown error";
+    }
+
+    job.mark_finished(outcome, std::move(error));
+    LOG_INFO("Job ", job.id(), " ", to_string(outcome), " after ", job.elapsed().count(), "ms");
+
+    std::lock_guard lock(mutex_);
+    this->retire(pending.job);
+    wake_.notify_all();
+  }
+}
+
+// Requires mutex_.
+void JobManager::retire(const std::shared_ptr<Job>& job) {
+  finished_.push_back(job->id());
+
+  while (finished_.size() > options_.history) {
+    jobs_.erase(finished_.front());
+    finished_.pop_front();
+  }
+}
+
+// Requires mutex_. Ids are random-looking, so they cannot be guessed from
+// one another, but never repeat within a process.
+std::string JobManager::next_id() {
+  // splitmix64 over a random seed.
+  uint64_t z{ id_state_ += 0x9E3779B97F4A7C15ull };
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  z ^= z >> 31;
+
+  char id[17];
+  std::snprintf(id, sizeof(id), "%016llx", static_cast<unsigned long long>(z));
+  return id;
+}
+
+} // namespace venturi::core
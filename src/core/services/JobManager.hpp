@@ -0,0 +1,155 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace venturi::core {
+
+enum class JobState { queued, running, completed, cancelled, failed };
+
+std::string_view to_string(JobState state);
+
+// One unit of background work and its live progress. The worker updates
+// the counters while anyone may read them.
+class Job {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  Job(std::string id, std::string kind, std::string key);
+
+  const std::string& id() const { return id_; }
+  const std::string& kind() const { return kind_; }
+  const std::string& key() const { return key_; }
+
+  JobState state() const { return state_.load(std::memory_order_acquire); }
+  bool finished() const;
+
+  // Work should poll this and return early once stop is requested.
+  std::stop_token stop_token() const { return stop_.get_token(); }
+
+  void add_directories(uint64_t count = 1) { directories_.fetch_add(count, std::memory_order_relaxed); }
+  void add_files(uint64_t count = 1) { files_.fetch_add(count, std::memory_order_relaxed); }
+
+  uint64_t directories() const { return directories_.load(std::memory_order_relaxed); }
+  uint64_t files() const { return files_.load(std::memory_order_relaxed); }
+
+  // Time spent running so far (or in total, once finished).
+  std::chrono::milliseconds elapsed() const;
+  double files_per_second() const;
+
+  // Set when the job failed.
+  std::string error() const;
+
+private:
+  friend class JobManager;
+
+  void mark_running();
+  void mark_finished(JobState state, std::string error = {});
+
+  const std::string id_;
+  const std::string kind_;
+  const std::string key_;
+
+  std::atomic<JobState> state_{ JobState::queued };
+  std::stop_source stop_;
+  std::atomic<uint64_t> directories_{ 0 };
+  std::atomic<uint64_t> files_{ 0 };
+
+  mutable std::mutex mutex_;
+  Clock::time_point started_at_;
+  Clock::time_point finished_at_;
+  std::string error_;
+};
+
+// Runs jobs on a small pool of dedicated worker threads, away from the
+// HTTP I/O threads. Submitting work whose key matches a job that is still
+// queued or running returns that job instead of queuing a duplicate.
+//
+// Jobs of a kind listed in Options::dedicated_kinds have their own queue
+// and worker; everything else shares the `worker_count` pool in FIFO order.
+class JobManager {
+public:
+  // Exceptions escaping the work mark the job failed.
+  using Work = std::function<void(Job&)>;
+
+  struct Options {
+    std::size_t worker_count{ 1 };
+
+    // Kinds that must not hold up the shared pool, e.g. hours-long paced
+    // copies that would otherwise keep scans queued behind them.
+    std::vector<std::string> dedicated_kinds;
+
+    // Finished jobs kept around for status queries.
+    std::size_t history{ 64 };
+
+    // Runs first on every worker thread, e.g. to lower its priority.
+    std::function<void()> on_worker_start;
+  };
+
+  explicit JobManager(Options options);
+  ~JobManager();
+
+  JobManager(const JobManager&) = delete;
+  JobManager& operator=(const JobManager&) = delete;
+
+  // With `join_running` false only a queued job absorbs the submission; a
+  // running one may already be past what the caller wants covered, so a
+  // follow-up is queued behind it instead.
+  std::shared_ptr<Job> submit(
+    std::string   kind,
+    std::string   key,
+    Work          work,
+    bool          join_running = true
+  );
+
+  std::shared_ptr<Job> find(const std::string& id) const;
+
+  // Queued and running jobs first, then finished ones, newest first.
+  std::vector<std::shared_ptr<Job>> list() const;
+
+  // Requests a stop. A queued job is cancelled at once; a running one
+  // when its work next checks the stop token. False if `id` is unknown.
+  bool cancel(const std::string& id);
+
+  // Blocks until no job of `kind` is queued or running, or `stop` is
+  // requested. Only for work on a dedicated lane: waiting on the lane
+  // that runs `kind` would never return.
+  void wait_idle(std::string_view kind, std::stop_token stop);
+
+private:
+  struct Pending {
+    std::shared_ptr<Job> job;
+    Work work;
+  };
+
+  // 0 for the shared pool, i + 1 for dedicated_kinds[i].
+  std::size_t lane_of(std::string_view kind) const;
+
+  void run_worker(std::stop_token stop, std::size_t lane);
+  void retire(const std::shared_ptr<Job>& job);
+  std::string next_id();
+
+  Options options_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable_any wake_;
+  std::vector<std::deque<Pending>> queues_;   // one per lane
+  std::unordered_map<std::string, std::shared_ptr<Job>> jobs_;
+  std::deque<std::string> finished_;
+  uint64_t id_state_;
+
+  // Last, so the workers are joined before anything they use goes away.
+  std::vector<std::jthread> workers_;
+};
+
+} // namespace venturi::core
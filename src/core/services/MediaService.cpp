@@ -1,90 +1,28 @@
 #include "MediaService.hpp"
 #include "../../../app/Logger.hpp"
-#include <regex>
 
-namespace venturi::core {
+namespace venturi::core::detail {
 
-MediaService::MediaService(
-    std::shared_ptr<IMediaRepository> repository
-) : repository_(std::move(repository))
-{}
-
-std::optional<MediaInfo> MediaService::get_media(const std::string& id) const {
-  return repository_->find_by_id(id);
-}
-
-std::vector<MediaInfo> MediaService::list_all_media() const {
-  return repository_->list_all();
-}
-
-size_t MediaService::scan_media_directory(
-  const std::filesystem::path& path
+size_t run_logged_scan(
+  const std::filesystem::path&                                                path,
+  const ScanHooks&                                                            hooks,
+  const std::function<size_t(const std::filesystem::path&, const ScanHooks&)>& walk
 ) {
   std::filesystem::path absolute_path{ std::filesystem::absolute(path) }; 
   LOG_INFO("Scanning media directory: ", absolute_path.string());
-  
-  size_t count = repository_->scan_directory(absolute_path, 
-    [this](const MediaInfo& info) {
-      LOG_DEBUG("Found media: ", info.file_path.string());
+
+  ScanHooks logged{ hooks };
+  logged.on_found = [&hooks](const MediaInfo& info) {
+    LOG_DEBUG("Found media: ", info.file_path);
+    if (hooks.on_found) {
+      hooks.on_found(info);
     }
-  );
+  };
+  
+  size_t count = walk(absolute_path, logged);
   
   LOG_INFO("Scan complete. Found ", count, " media files");
   return count;
 }
 
-uint64_t MediaService::get_media_size(const std::string& media_id) const {
-  auto media = repository_->find_by_id(media_id);
-  if (!media) {
-    return 0;
-  }
-  
-  return repository_->get_file_size(media->file_path);
-}
-
-std::optional<ByteRange> MediaService::parse_range_header(
-  const std::string& range_header,
-  uint64_t file_size
-) const {
-  // "bytes=start-end" format
-  // "bytes=0-1023", "bytes=1024-", "bytes=-500"
-  
-  static const std::regex range_regex(
-    R"(bytes=(\d*)-(\d*))",
-    std::regex::icase
-  );
-  
-  std::smatch matches;
-  if (!std::regex_match(range_header, matches, range_regex)) {
-    return std::nullopt;
-  }
-  
-  ByteRange range;
-  range.total_size = file_size;
-  
-  const std::string start_str = matches[1].str();
-  const std::string end_str = matches[2].str();
-  
-  if (start_str.empty() && end_str.empty()) {
-    return std::nullopt;
-  }
-  
-  if (start_str.empty()) {
-    uint64_t suffix_length = std::stoull(end_str);
-    range.start = file_size > suffix_length ? 
-      file_size - suffix_length : 0;
-    range.end = file_size - 1;
-  } else {
-    range.start = std::stoull(start_str);
-    range.end = end_str.empty() ? 
-      file_size - 1 : std::stoull(end_str);
-  }
-  
-  if (!range.is_valid()) {
-    return std::nullopt;
-  }
-  
-  return range;
-}
-
-} // namespace venturi::core
\ No newline at end of file
+} // namespace venturi::core::detail
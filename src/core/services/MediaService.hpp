@@ -1,33 +1,147 @@
 #pragma once
-#include "../ports/IMediaRepository.hpp"
+#include "../ports/MediaRepository.hpp"
 #include "../entities/MediaInfo.hpp"
+#include "RangeParser.hpp"
+#include "JobManager.hpp"
+#include <filesystem>
+#include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 #include <optional>
+#include <string_view>
 
 namespace venturi::core {
 
+namespace detail {
+
+// Logs a scan of `path` around `walk`, which performs it with the hooks it
+// is handed. Shared by every MediaService instantiation.
+size_t run_logged_scan(
+  const std::filesystem::path&                                                path,
+  const ScanHooks&                                                            hooks,
+  const std::function<size_t(const std::filesystem::path&, const ScanHooks&)>& walk
+);
+
+} // namespace detail
+
+// Instantiated against the concrete repository (see MediaRepository), so
+// lookups on the request path are direct, inlinable calls. Use
+// MediaService<AnyMediaRepository> to pick the repository at run time.
+template <MediaRepository Repo>
 class MediaService {
 public:
   MediaService(
-    std::shared_ptr<IMediaRepository> repository
-  );
-  
-  std::optional<MediaInfo> get_media(const std::string& id) const;
-  
-  std::vector<MediaInfo> list_all_media() const;
-  
-  size_t scan_media_directory(const std::filesystem::path& path);
-  
-  uint64_t get_media_size(const std::string& media_id) const;
-
-  std::optional<ByteRange> parse_range_header(
-    const std::string& range_header,
-    uint64_t file_size
-  ) const;
+    std::shared_ptr<Repo>  repository,
+    JobManager::Options    job_options = {}
+  ) : repository_(std::move(repository))
+    , jobs_(std::make_unique<JobManager>(std::move(job_options)))
+  {}
+
+  MediaHandle get_media(MediaId id) const {
+    return repository_->find_by_id(id);
+  }
+
+  MediaList list_all_media() const {
+    return repository_->list_all();
+  }
+
+  // See MediaRepository::list_page.
+  MediaList list_media_page(
+    const std::filesystem::path& after,
+    std::size_t limit
+  ) const {
+    return repository_->list_page(after, limit);
+  }
+
+  // Walks `path` on the calling thread.
+  size_t scan_media_directory(
+    const std::filesystem::path& path,
+    const ScanHooks& hooks = {}
+  ) {
+    return detail::run_logged_scan(path, hooks,
+      [this](const std::filesystem::path& absolute_path, const ScanHooks& logged) {
+        return repository_->scan_directory(absolute_path, logged);
+      }
+    );
+  }
+
+  // Queues a scan of `path` as a background job and returns at once. A
+  // scan of the same path that is still queued or running is returned
+  // instead of starting another.
+  std::shared_ptr<const Job> start_scan(const std::filesystem::path& path) {
+    std::filesystem::path absolute_path{ std::filesystem::absolute(path).lexically_normal() };
+
+    return jobs_->submit("scan", "scan:" + absolute_path.string(),
+      [this, absolute_path](Job& job) {
+        ScanHooks hooks;
+        hooks.on_found = [&job](const MediaInfo&) { job.add_files(); };
+        hooks.on_directory = [&job](const std::filesystem::path&) { job.add_directories(); };
+        hooks.stop_token = job.stop_token();
+
+        this->scan_media_directory(absolute_path, hooks);
+      }
+    );
+  }
+
+  // Queues other background work the same way, deduplicated by `key`
+  // (see JobManager::submit for `join_running`).
+  std::shared_ptr<const Job> start_job(
+    std::string        kind,
+    std::string        key,
+    JobManager::Work   work,
+    bool               join_running = true
+  ) {
+    return jobs_->submit(std::move(kind), std::move(key), std::move(work), join_running);
+  }
+
+  // See JobManager::wait_idle.
+  void wait_for_jobs(std::string_view kind, std::stop_token stop) {
+    jobs_->wait_idle(kind, std::move(stop));
+  }
+
+  std::shared_ptr<const Job> find_job(const std::string& id) const {
+    return jobs_->find(id);
+  }
+
+  std::vector<std::shared_ptr<const Job>> list_jobs() const {
+    auto jobs{ jobs_->list() };
+    return { jobs.begin(), jobs.end() };
+  }
+
+  bool cancel_job(const std::string& id) {
+    return jobs_->cancel(id);
+  }
+
+  uint64_t get_media_size(MediaId media_id) const {
+    auto media = repository_->find_by_id(media_id);
+    if (!media) {
+      return 0;
+    }
+
+    return repository_->get_file_size(media->file_path);
+  }
+
+  // See MediaRepository::generation.
+  uint64_t catalog_generation() const {
+    return repository_->generation();
+  }
+
+  // Parses a `Range` header into ascending, non-overlapping ranges of a
+  // `file_size` byte file. See parse_byte_ranges() for the exact rules.
+  RangeParseStatus parse_range_header(
+    std::string_view range_header,
+    uint64_t file_size,
+    ByteRangeSet& ranges
+  ) const {
+    return parse_byte_ranges(range_header, file_size, ranges);
+  }
 
 private:
-  std::shared_ptr<IMediaRepository> repository_;
+  std::shared_ptr<Repo> repository_;
+
+  // Last: its workers use this service and must stop first.
+  std::unique_ptr<JobManager> jobs_;
 };
 
-} // namespace venturi::core
\ No newline at end of file
+} // namespace venturi::core
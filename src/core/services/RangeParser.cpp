@@ -0,0 +1,195 @@
+#include "RangeParser.hpp"
+#include <algorithm>
+#include <charconv>
+#include <limits>
+
+namespace venturi::core {
+
+namespace {
+
+constexpr uint64_t max_position{ std::numeric_limits<uint64_t>::max() };
+
+bool is_digit(char c) { return c >= '0' && c <= '9'; }
+bool is_ows(char c) { return c == ' ' || c == '\t'; }
+
+// Consumes 1*DIGIT. Values that overflow saturate to max_position, which
+// is past the end of any file.
+bool parse_position(std::string_view& input, uint64_t& value) {
+  std::size_t digits{ 0 };
+  while (digits < input.size() && is_digit(input[digits])) {
+    ++digits;
+  }
+  if (digits == 0) {
+    return false;
+  }
+
+  auto [ptr, ec] = std::from_chars(input.data(), input.data() + digits, value);
+  if (ec == std::errc::result_out_of_range) {
+    value = max_position;
+  }
+
+  input.remove_prefix(digits);
+  return true;
+}
+
+bool starts_with_bytes_unit(std::string_view value) {
+  constexpr std::string_view unit{ "bytes=" };
+  if (value.size() < unit.size()) {
+    return false;
+  }
+
+  for (std::size_t i{ 0 }; i < unit.size(); ++i) {
+    char c{ value[i] };
+    if (c >= 'A' && c <= 'Z') {
+      c = static_cast<char>(c - 'A' + 'a');
+    }
+    if (c != unit[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Inserts keeping `ranges` sorted by start and merged.
+void insert_coalesced(ByteRangeSet& set, ByteRange range) {
+  std::size_t i{ set.count };
+  while (i > 0 && set.ranges[i - 1].start > range.start) {
+    --i;
+  }
+
+  // Merge with the predecessor if it overlaps or touches.
+  if (i > 0 && set.ranges[i - 1].end + 1 >= range.start) {
+    --i;
+    set.ranges[i].end = std::max(set.ranges[i].end, range.end);
+  } else {
+    for (std::size_t j{ set.count }; j > i; --j) {
+      set.ranges[j] = set.ranges[j - 1];
+    }
+    set.ranges[i] = range;
+    ++set.count;
+  }
+
+  // Swallow successors that now overlap or touch.
+  std::size_t next{ i + 1 };
+  while (next < set.count && set.ranges[i].end + 1 >= set.ranges[next].start) {
+    set.ranges[i].end = std::max(set.ranges[i].end, set.ranges[next].end);
+    ++next;
+  }
+
+  const std::size_t removed{ next - (i + 1) };
+  if (removed > 0) {
+    for (std::size_t j{ i + 1 }; j + removed < set.count; ++j) {
+      set.ranges[j] = set.ranges[j + removed];
+    }
+    set.count -= removed;
+  }
+}
+
+RangeParseStatus parse_range_set(
+  std::string_view  value,
+  uint64_t          file_size,
+  ByteRangeSet&     ranges
+) {
+  if (!starts_with_bytes_unit(value)) {
+    return RangeParseStatus::ignored;
+  }
+  value.remove_prefix(6);
+
+  std::size_t specs{ 0 };
+  bool expect_spec{ true };
+
+  while (true) {
+    // List elements may be empty and are separated by OWS "," OWS.
+    while (!value.empty() && (is_ows(value.front()) || value.front() == ',')) {
+      if (value.front() == ',') {
+        expect_spec = true;
+      }
+      value.remove_prefix(1);
+    }
+
+    if (value.empty()) {
+      break;
+    }
+    if (!expect_spec) {
+      return RangeParseStatus::ignored;
+    }
+    expect_spec = false;
+
+    if (++specs > ByteRangeSet::capacity) {
+      return RangeParseStatus::ignored;
+    }
+
+    ByteRange range;
+    range.total_size = file_size;
+    bool satisfiable{ false };
+
+    if (value.front() == '-') {
+      value.remove_prefix(1);
+
+      uint64_t suffix{ 0 };
+      if (!parse_position(value, suffix)) {
+        return RangeParseStatus::ignored;
+      }
+
+      if (suffix > 0 && file_size > 0) {
+        range.start = suffix >= file_size ? 0 : file_size - suffix;
+        range.end = file_size - 1;
+        satisfiable = true;
+      }
+    } else {
+      uint64_t first{ 0 };
+      if (!parse_position(value, first) || value.empty() || value.front() != '-') {
+        return RangeParseStatus::ignored;
+      }
+      value.remove_prefix(1);
+
+      uint64_t last{ max_position };
+      if (!value.empty() && is_digit(value.front())) {
+        parse_position(value, last);
+        if (last < first) {
+          return RangeParseStatus::ignored;
+        }
+      }
+
+      if (first < file_size) {
+        range.start = first;
+        range.end = std::min(last, file_size - 1);
+        satisfiable = true;
+      }
+    }
+
+    // Only OWS or a comma may follow a spec.
+    if (!value.empty() && !is_ows(value.front()) && value.front() != ',') {
+      return RangeParseStatus::ignored;
+    }
+
+    if (satisfiable) {
+      insert_coalesced(ranges, range);
+    }
+  }
+
+  if (specs == 0) {
+    return RangeParseStatus::ignored;
+  }
+
+  return ranges.empty() ? RangeParseStatus::unsatisfiable : RangeParseStatus::ok;
+}
+
+} // namespace
+
+RangeParseStatus parse_byte_ranges(
+  std::string_view  value,
+  uint64_t          file_size,
+  ByteRangeSet&     ranges
+) noexcept {
+  ranges.count = 0;
+
+  auto status{ parse_range_set(value, file_size, ranges) };
+  if (status != RangeParseStatus::ok) {
+    // A malformed tail invalidates the whole header, not just that spec.
+    ranges.count = 0;
+  }
+  return status;
+}
+
+} // namespace venturi::core
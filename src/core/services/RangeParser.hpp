@@ -0,0 +1,30 @@
+#pragma once
+#include "../entities/MediaInfo.hpp"
+#include <cstdint>
+#include <string_view>
+
+namespace venturi::core {
+
+enum class RangeParseStatus {
+  ok,             // `ranges` holds at least one satisfiable range
+  unsatisfiable,  // well-formed, but nothing overlaps the file: 416
+  ignored,        // malformed, unknown unit or too many specs: serve 200
+};
+
+// Parses a `Range` field value per RFC 9110 section 14.
+//
+//   Range       = range-unit "=" range-set        ; unit: "bytes", any case
+//   range-set   = 1#range-spec                   ; OWS only around commas
+//   range-spec  = first-pos "-" [ last-pos ] / "-" suffix-length
+//
+// Satisfiable specs are clamped to `file_size`, sorted and coalesced
+// (overlapping or adjacent ranges merge) into `ranges`. Positions too large
+// for uint64_t are treated as beyond the end of the file rather than as
+// errors. Never allocates and never throws.
+RangeParseStatus parse_byte_ranges(
+  std::string_view  value,
+  uint64_t          file_size,
+  ByteRangeSet&     ranges
+) noexcept;
+
+} // namespace venturi::core